@@ -4,39 +4,173 @@
 #include <string>
 #include <functional>
 #include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "game_structures.h"
+#include "collider_grid.h"
+#include "bitboard_bfs.h"
+#include "search_space.h"
+#include "jump_point_search.h"
+#include "hierarchical_path.h"
+#include "distance_table.h"
+#include "incremental_planner.h"
+#include "path_cache.h"
+#include "sliced_search.h"
+#include "reservation_table.h"
+#include "path_buffer.h"
 
-struct Spot
+class Path_service;
+
+struct Path_query
 {
-	Index spot_index;
-	int f;
-	int h;
-	int g;
-	bool wall;
+	Position start;
+	Position goal;
+};
 
-	int parent{ -1 };
+// Paths of a batch stored one after the other, each goal first like create_center_path.
+// Path i is positions[offsets[i]] to positions[offsets[i + 1]], empty if unreachable.
+// Reusing the same batch keeps its capacity from one call to the next.
+struct Path_batch
+{
+	std::vector<Position> positions;
+	std::vector<size_t> offsets;
 };
 
 class A_star
 {
 public:
 	A_star(Map_infos const& infos);
+	A_star(A_star const&) = delete;
+	A_star & operator=(A_star const&) = delete;
 
 	void load_map_infos(Map_infos const& infos);
 	void create_spots();
 	std::vector<Position> create_center_path(float x_1, float y_1, float x_2, float y_2);
+	// Same path written into the buffer, returns its length : 0 if unreachable or
+	// longer than the buffer. No allocation once the buffer holds max_path_length()
+	size_t write_center_path(Path_buffer & buffer, float x_1, float y_1, float x_2, float y_2);
+	size_t max_path_length() const;
+	// Same result as create_center_path, searched with Jump Point Search
+	std::vector<Position> create_jump_path(float x_1, float y_1, float x_2, float y_2);
+	// For large maps : only the part up to the first cluster entrance is cell by cell
+	std::vector<Position> create_hierarchical_path(float x_1, float y_1, float x_2, float y_2);
+	// Repairs the search state kept by the agent instead of searching again.
+	// While a repair is over the budget the last complete path is returned.
+	std::vector<Position> create_incremental_path(Incremental_planner & planner, float x_1, float y_1, float x_2, float y_2);
+	// create_center_path, reusing the agent's last path while it still applies
+	std::vector<Position> create_cached_path(Path_cache & cache, float x_1, float y_1, float x_2, float y_2);
+
+	// Time-sliced search : start it here, step() it over frames, then read its path.
+	// A path searched across a collider change is refused.
+	bool start_sliced_search(Sliced_search & search, float x_1, float y_1, float x_2, float y_2);
+	bool sliced_search_path(Sliced_search const& search, std::vector<Position> & path) const;
+
+	// Windowed cooperative A* : plans window steps in space and time around the
+	// tiles other agents reserved, waiting being a move, then reserves its own ;
+	// an agent reaching its goal early holds that tile until the window ends.
+	// Starts from the corner farther from the goal, like choose_path. A wait
+	// repeats the position in the path.
+	std::vector<Position> create_cooperative_path(Reservation_table & reservations, ecs::Id const& agent, Position const& corner_1, Position const& corner_2, Position const& goal, int window);
+
+	// Independent queries answered in parallel, every thread with its own scratch
+	void find_paths(std::vector<Path_query> const& queries, Path_batch & result);
+	// Most threads a batch uses, 0 for one per hardware thread
+	void set_batch_threads(size_t nb_threads);
+
+	Size get_tile_size() const;
+
+	void set_collider(Index const& index, bool wall);
+	// Service told of every collider change, so its next snapshots match this map.
+	// nullptr to stop ; the service must outlive this A_star otherwise.
+	void set_path_service(Path_service * path_service);
+
+	// Small maps only : create_center_path then walks a precomputed all-pairs table.
+	// Never built next to the flow field, which drops it. No cache file for an empty path.
+	bool enable_distance_table(std::string const& cache_path);
+	void disable_distance_table();
+
+	// Flow field : one BFS distance field toward a single target, shared by every agent,
+	// grown on bitboards
+	void set_flow_field_enabled(bool enabled);
+	bool flow_field_enabled() const;
+	void update_flow_field(float x, float y);
+	bool flow_field_targets(float x, float y) const;
+	int flow_distance(float x, float y) const;
+	bool flow_next_position(float x, float y, Position & next) const;
 
 	~A_star();
 
 private:
-	Index get_corresponding_index(float x, float y);
-	std::vector<Position> extract_path(std::vector<Spot> & close_set);
+	// Scratch of one find_paths thread, kept between batches
+	struct Batch_worker
+	{
+		Search_space search;
+		std::vector<Position> positions;
+		std::vector<size_t> lengths;
+	};
+
+	Index get_corresponding_index(float x, float y) const;
+	void run_batch(Batch_worker & worker, std::vector<Path_query> const& queries, size_t first, size_t last) const;
+	// Loop of the batch thread answering the share index of every batch after round
+	void batch_thread(size_t index, size_t round);
+	bool is_inside(Index const& index) const;
+	Position cell_center(int cell) const;
+	int flow_cell_distance(int cell) const;
+	int field_distance(std::vector<int> const& distances, int cell) const;
+	int flow_next_cell(int cell) const;
+	std::vector<Position> extract_path(int goal_cell);
+	size_t write_search_path(Path_buffer & buffer, int goal_cell) const;
+	size_t write_flow_path(Path_buffer & buffer, int start_cell) const;
+	size_t write_cells(Path_buffer & buffer, std::vector<int> const& cells) const;
+	std::vector<Position> extract_flow_path(int start_cell) const;
+	std::vector<Position> cells_to_path(std::vector<int> const& cells) const;
+	void trim_collider_changes();
 
 	int m_nb_rows;
 	int m_nb_cols;
 	Size m_tile_size;
 
-	std::vector<bool> m_wall_map;
-	std::vector<Spot> m_spot_map;
+	Collider_grid m_colliders;
+
+	Search_space m_search;
+	std::vector<Batch_worker> m_batch_workers;
+	// Threads of find_paths, started with the first batch that needs them and
+	// waiting for the next one in between. Share 0 is run by the caller.
+	std::vector<std::thread> m_batch_threads;
+	size_t m_batch_max_threads{ 0 };
+	std::mutex m_batch_mutex;
+	std::condition_variable m_batch_wake;
+	std::condition_variable m_batch_done;
+	std::vector<Path_query> const* m_batch_queries{ nullptr };
+	size_t m_batch_shares{ 0 };
+	size_t m_batch_queries_per_share{ 0 };
+	size_t m_batch_round{ 0 };
+	size_t m_batch_running{ 0 };
+	bool m_batch_stopping{ false };
+	Jump_point_search m_jump_search;
+	Hierarchical_path m_hierarchical_path;
+	Distance_table m_distance_table;
+	// Kept for write_center_path, so table paths reuse its capacity
+	std::vector<int> m_table_cells;
+	// Collider changes from m_collider_log_base on, kept until every bound
+	// incremental planner has replayed them
+	std::vector<Index> m_collider_changes;
+	size_t m_collider_log_base{ 0 };
+	size_t m_collider_revision{ 0 };
+	std::vector<std::weak_ptr<size_t const>> m_planner_revisions;
+
+	bool m_flow_enabled{ false };
+	int m_flow_target{ -1 };
+	std::vector<int> m_flow_distances;
+	Bitboard_bfs m_flow_bfs;
+
+	Path_service * m_path_service{ nullptr };
+
+	int m_cooperative_goal{ -1 };
+	size_t m_cooperative_revision{ 0 };
+	std::vector<int> m_cooperative_distances;
+	Search_space m_cooperative_search;
 };
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <cstddef>
+#include <cassert>
+#include <utility>
+
+#include "entity.h"
+
+namespace ecs
+{
+	constexpr size_t chunk_bytes{ 16 * 1024 };
+
+	// Storage for entities that all own the same component set.
+	// Entities are packed in fixed-size chunks, each component stored as its own
+	// column (SoA), so a system walks every column linearly without id matching.
+	// Rows stay packed : erase moves the last row into the freed one.
+	template <typename... Components>
+	class Archetype
+	{
+	public:
+		static constexpr size_t row_bytes{ sizeof(Id) + (sizeof(Components) + ...) };
+		static constexpr size_t chunk_capacity{ chunk_bytes / row_bytes };
+		static_assert(chunk_capacity > 0, "Components too large for one chunk");
+
+		static constexpr size_t npos{ static_cast<size_t>(-1) };
+
+		struct Chunk
+		{
+			size_t count{ 0 };
+			std::array<Id, chunk_capacity> ids;
+			std::tuple<std::array<Components, chunk_capacity>...> columns;
+		};
+
+		void push_back(Id const& id, Components const&... components)
+		{
+			assert(!contains(id));
+
+			if (m_size == m_chunks.size() * chunk_capacity)
+			{
+				m_chunks.push_back(std::make_unique<Chunk>());
+			}
+
+			const size_t row{ m_size };
+			Chunk & chunk{ *m_chunks[row / chunk_capacity] };
+			const size_t slot{ row % chunk_capacity };
+
+			chunk.ids[slot] = id;
+			((column<Components>(chunk)[slot] = components), ...);
+			chunk.count++;
+
+			const size_t key{ entity_index(id) };
+			if (key >= m_sparse.size())
+			{
+				m_sparse.resize(key + 1, npos);
+			}
+			m_sparse[key] = row;
+			m_size++;
+		}
+
+		bool erase(Id const& id)
+		{
+			if (!contains(id))
+			{
+				return false;
+			}
+
+			const size_t row{ m_sparse[entity_index(id)] };
+			const size_t last{ m_size - 1 };
+
+			Chunk & chunk{ *m_chunks[row / chunk_capacity] };
+			Chunk & last_chunk{ *m_chunks[last / chunk_capacity] };
+
+			if (row != last)
+			{
+				const size_t slot{ row % chunk_capacity };
+				const size_t last_slot{ last % chunk_capacity };
+
+				chunk.ids[slot] = last_chunk.ids[last_slot];
+				((column<Components>(chunk)[slot] = std::move(column<Components>(last_chunk)[last_slot])), ...);
+				m_sparse[entity_index(chunk.ids[slot])] = row;
+			}
+
+			last_chunk.count--;
+			m_sparse[entity_index(id)] = npos;
+			m_size--;
+
+			// Keep one empty chunk around so an add/remove pattern does not reallocate
+			if (m_chunks.size() > 1 && m_size <= (m_chunks.size() - 2) * chunk_capacity)
+			{
+				m_chunks.pop_back();
+			}
+
+			return true;
+		}
+
+		bool contains(Id const& id) const
+		{
+			const size_t key{ entity_index(id) };
+			if (key >= m_sparse.size() || m_sparse[key] == npos)
+			{
+				return false;
+			}
+
+			const size_t row{ m_sparse[key] };
+			return m_chunks[row / chunk_capacity]->ids[row % chunk_capacity] == id;
+		}
+
+		template <typename Component>
+		Component & get(Id const& id)
+		{
+			assert(contains(id));
+			const size_t row{ m_sparse[entity_index(id)] };
+			return column<Component>(*m_chunks[row / chunk_capacity])[row % chunk_capacity];
+		}
+
+		// function(size_t count, Id const* ids, Components*... columns), once per chunk
+		template <typename Function>
+		void for_each_chunk(Function && function)
+		{
+			for (auto & chunk : m_chunks)
+			{
+				if (chunk->count != 0)
+				{
+					function(chunk->count, chunk->ids.data(), column<Components>(*chunk).data()...);
+				}
+			}
+		}
+
+		// function(Id const&, Components&...), once per entity
+		template <typename Function>
+		void for_each(Function && function)
+		{
+			for_each_chunk([&function](size_t count, Id const* ids, Components*... columns)
+			{
+				for (size_t i{ 0 }; i < count; i++)
+				{
+					function(ids[i], columns[i]...);
+				}
+			});
+		}
+
+		void clear()
+		{
+			m_chunks.clear();
+			m_sparse.clear();
+			m_size = 0;
+		}
+
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+
+	private:
+		template <typename Component>
+		static std::array<Component, chunk_capacity> & column(Chunk & chunk)
+		{
+			return std::get<std::array<Component, chunk_capacity>>(chunk.columns);
+		}
+
+		std::vector<std::unique_ptr<Chunk>> m_chunks;
+		std::vector<size_t> m_sparse;
+		size_t m_size{ 0 };
+	};
+}
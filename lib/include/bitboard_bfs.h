@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "collider_grid.h"
+
+// Breadth-first distance field grown on bitboards : each step dilates the whole
+// frontier with shifts and ANDs, 64 tiles per word, and only walks the words
+// next to the frontier.
+class Bitboard_bfs
+{
+public:
+	Bitboard_bfs();
+
+	// Steps from every tile to target_cell, -1 for walls and unreachable tiles
+	void compute(Collider_grid const& colliders, int target_cell, std::vector<int> & distances);
+
+	~Bitboard_bfs();
+
+private:
+	void prepare(Collider_grid const& colliders);
+
+	// Border words around every row and a border row above and below
+	int m_stride{ 0 };
+	std::vector<std::uint64_t> m_open;
+	std::vector<std::uint64_t> m_visited;
+	std::vector<std::uint64_t> m_frontier;
+	std::vector<std::uint64_t> m_next;
+
+	// Range of the non empty words of each frontier row
+	std::vector<int> m_first_words;
+	std::vector<int> m_last_words;
+	std::vector<int> m_next_first_words;
+	std::vector<int> m_next_last_words;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "game_structures.h"
+
+// Boxes stored as x, y, w and h columns, tested all at once against one box :
+// 8 boxes per compare with AVX2, 4 with SSE, picked on the first test from
+// what the cpu supports (GCC, Clang and MSVC on x86, scalar elsewhere).
+// Same overlap test as ecs::check_collision, edges touching is no overlap.
+class Box_batch
+{
+public:
+	Box_batch();
+
+	void push_back(Position const& pos, Size const& size);
+	void clear();
+	void reserve(size_t capacity);
+	size_t size() const;
+
+	// Indices of the boxes overlapping the given one, in order, added to hits
+	void overlapping(Position const& pos, Size const& size, std::vector<size_t> & hits) const;
+
+	static bool uses_avx2();
+	static bool uses_sse();
+
+	~Box_batch();
+
+private:
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_w;
+	std::vector<float> m_h;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Collider map packed one bit per tile, each row starting on a 64-bit word.
+// Bits past the last column are set, so word scans see the border as a wall.
+// Queries read whole words : 64 tiles per test.
+class Collider_grid
+{
+public:
+	static constexpr int word_bits{ 64 };
+
+	Collider_grid();
+	Collider_grid(int nb_cols, int nb_rows, std::vector<bool> const& wall_map);
+
+	int nb_cols() const;
+	int nb_rows() const;
+	size_t nb_cells() const;
+	int words_per_row() const;
+
+	// Tiles outside the grid are walls
+	bool is_wall(int x, int y) const;
+	bool is_wall(int cell) const;
+	void set_wall(int x, int y, bool wall);
+
+	// Any wall in the tiles from (x_1, y_1) to (x_2, y_2) included
+	bool any_wall(int x_1, int y_1, int x_2, int y_2) const;
+	// First wall walking the row from x_from to x_to (both included, either way), -1 if none
+	int first_wall(int y, int x_from, int x_to) const;
+
+	// Bit i is the tile word * 64 + i of the row
+	std::uint64_t row_word(int y, int word) const;
+	// Bit i set when the tile (word * 64 + i + dx, y + dy) is open, dx and dy in [-1, 1]
+	std::uint64_t open_neighbors(int y, int word, int dx, int dy) const;
+
+	std::vector<bool> to_wall_map() const;
+
+	~Collider_grid();
+
+private:
+	// Bits from first to last included
+	static std::uint64_t bit_range(int first, int last);
+
+	int m_nb_cols{ 0 };
+	int m_nb_rows{ 0 };
+	int m_words_per_row{ 0 };
+	std::vector<std::uint64_t> m_words;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+#include "path_buffer.h"
+#include "a_star.h"
+
+// An ai follows the longer of the paths leaving its top left and bottom
+// right corners. corner_length(corner, position) gives the length of the
+// path from a corner, 0 for the top left one ; returns the corner to follow
+template<typename Corner_length>
+int longer_corner(Position const& pos_target, Size const& size_target, Corner_length corner_length)
+{
+	const auto length_1{ corner_length(0, pos_target) };
+	const auto length_2{ corner_length(1, Position{ pos_target.x + size_target.width, pos_target.y + size_target.height }) };
+
+	return length_1 > length_2 ? 0 : 1;
+}
+
+// Second to last step of a path, the one after the ai tile
+bool next_step(std::vector<Position> const& path, Position & next_position);
+
+// Both corner paths written into the ai's own buffers : no allocation once
+// they hold A_star::max_path_length()
+bool choose_buffered_step(A_star & path_finding, Path_buffer (&corners)[2], Position const& pos_target, Size const& size_target, Position const& final_pos, Position & next_position);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// All-pairs next hop and distance between walkable tiles, for small mazes.
+// Built once with one BFS per walkable tile (spread over threads), a path is
+// then a walk through the table without any search. The table can be cached
+// in a file and is only reused if it was built for the same collider map.
+class Distance_table
+{
+public:
+	static constexpr int max_walkable_tiles{ 4096 };
+
+	Distance_table();
+
+	bool build(int nb_cols, int nb_rows, std::vector<bool> const& wall_map);
+	bool save(std::string const& file_path) const;
+	bool load(std::string const& file_path, int nb_cols, int nb_rows, std::vector<bool> const& wall_map);
+	void clear();
+
+	bool is_built() const;
+	// Steps between two cells, -1 if unreachable or not walkable
+	int distance(int start_cell, int goal_cell) const;
+	// Cells from goal back to start, false if the goal cannot be reached
+	bool find_path(int start_cell, int goal_cell, std::vector<int> & cells) const;
+
+	~Distance_table();
+
+private:
+	static constexpr std::uint8_t no_hop{ 0xFF };
+
+	void index_walkable(int nb_cols, int nb_rows, std::vector<bool> const& wall_map);
+	void fill_from_goals(int first_goal, int last_goal);
+	int neighbor_cell(int cell, int direction) const;
+	std::uint64_t map_hash(std::vector<bool> const& wall_map) const;
+
+	int m_nb_cols{ 0 };
+	int m_nb_rows{ 0 };
+	int m_nb_walkable{ 0 };
+	std::uint64_t m_hash{ 0 };
+
+	std::vector<int> m_cell_to_slot;
+	std::vector<int> m_slot_to_cell;
+
+	// Indexed [goal slot * walkable + from slot]
+	std::vector<std::uint8_t> m_next_hops;
+	std::vector<std::uint16_t> m_distances;
+};
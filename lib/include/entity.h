@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ecs
+{
+	// An entity id packs a slot index (low 32 bits) and the generation of that
+	// slot (high 32 bits). Destroying an entity bumps the generation, so copies of
+	// the old id kept by AI or collision code are detected as dead.
+	using Id = std::uint64_t;
+
+	constexpr Id null_entity{ 0 };
+
+	inline std::uint32_t entity_index(Id const& id)
+	{
+		return static_cast<std::uint32_t>(id & 0xFFFFFFFFu);
+	}
+
+	inline std::uint32_t entity_generation(Id const& id)
+	{
+		return static_cast<std::uint32_t>(id >> 32);
+	}
+
+	inline Id make_entity(std::uint32_t index, std::uint32_t generation)
+	{
+		return (static_cast<Id>(generation) << 32) | index;
+	}
+
+	// Hands out ids and recycles destroyed slots through a free-list.
+	// create, destroy and alive are all O(1).
+	class Entity_pool
+	{
+	public:
+		Id create()
+		{
+			std::uint32_t index;
+
+			if (!m_free_indices.empty())
+			{
+				index = m_free_indices.back();
+				m_free_indices.pop_back();
+			}
+			else
+			{
+				index = static_cast<std::uint32_t>(m_generations.size());
+				m_generations.push_back(1);
+			}
+
+			m_nb_alive++;
+
+			return make_entity(index, m_generations[index]);
+		}
+
+		bool destroy(Id const& id)
+		{
+			if (!alive(id))
+			{
+				return false;
+			}
+
+			const std::uint32_t index{ entity_index(id) };
+
+			m_generations[index]++;
+			if (m_generations[index] == 0) // Never hand out null_entity
+			{
+				m_generations[index] = 1;
+			}
+
+			m_free_indices.push_back(index);
+			m_nb_alive--;
+
+			return true;
+		}
+
+		bool alive(Id const& id) const
+		{
+			const std::uint32_t index{ entity_index(id) };
+			return index < m_generations.size() && m_generations[index] == entity_generation(id);
+		}
+
+		size_t size() const { return m_nb_alive; }
+		bool empty() const { return m_nb_alive == 0; }
+
+		void clear()
+		{
+			m_generations.clear();
+			m_free_indices.clear();
+			m_nb_alive = 0;
+		}
+
+	private:
+		std::vector<std::uint32_t> m_generations;
+		std::vector<std::uint32_t> m_free_indices;
+		size_t m_nb_alive{ 0 };
+	};
+}
@@ -36,6 +36,8 @@ struct Mob_infos
 	Size size;
 	Speed speed;
 	Animation_infos animation;
+	// How an ennemie searches its path, empty for the default one
+	std::string pathing;
 };
 
 struct Map_infos
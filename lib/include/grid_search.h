@@ -0,0 +1,16 @@
+#pragma once
+
+#include "game_structures.h"
+#include "collider_grid.h"
+#include "search_space.h"
+
+// The A* every plain grid search runs : 4 neighbors, unit steps, Manhattan
+// heuristic, outside the map reads as a wall. Once found, the parents left in
+// the search space lead from the goal back to the start.
+enum class Grid_search_state { running, found, failed };
+
+void start_grid_search(Search_space & search, Collider_grid const& colliders, Index const& start, Index const& goal);
+// Expands nodes until the search ends or budget runs out, budget is decreased by the nodes expanded
+Grid_search_state expand_grid_search(Search_space & search, Collider_grid const& colliders, Index const& goal, int & budget);
+// Whole search at once
+bool find_grid_path(Search_space & search, Collider_grid const& colliders, Index const& start, Index const& goal);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+#include "search_space.h"
+
+// HPA* : the grid is cut into square clusters, entrances are placed on the
+// open runs of each cluster border, and the cost between entrances of the same
+// cluster is precomputed. A query searches this abstract graph and only refines
+// the first segment into cells. Changing a collider rebuilds the touched
+// cluster and its neighbors only.
+class Hierarchical_path
+{
+public:
+	Hierarchical_path();
+
+	void rebuild(int nb_cols, int nb_rows, std::vector<bool> const& wall_map, int cluster_size);
+	void set_wall(Index const& index, bool wall);
+
+	// Cells from goal back to start : cell by cell up to the first waypoint, then
+	// one cell per abstract node. False if the goal cannot be reached.
+	bool find_path(Index const& start, Index const& goal, std::vector<int> & cells);
+
+	size_t nb_abstract_nodes() const;
+
+	struct Abstract_edge
+	{
+		int from_cell;
+		int to_cell;
+		int cost;
+	};
+	// Every edge of the abstract graph by cell, node ids aside
+	void abstract_edges(std::vector<Abstract_edge> & edges) const;
+
+	~Hierarchical_path();
+
+private:
+	struct Edge
+	{
+		int to;
+		int cost;
+	};
+
+	struct Node
+	{
+		int cell{ -1 };
+		int cluster{ -1 };
+		bool alive{ false };
+		std::vector<Edge> edges;
+	};
+
+	// Border on the right (side 0) or bottom (side 1) of a cluster
+	struct Border
+	{
+		std::vector<int> nodes;
+	};
+
+	bool is_open(int x, int y) const;
+	int cluster_of(int cell) const;
+	void cluster_bounds(int cluster, int & x1, int & y1, int & x2, int & y2) const;
+
+	int add_node(int cell);
+	void remove_node(int node);
+	void build_border(int cluster, int side);
+	void clear_border(int cluster, int side);
+	void build_cluster_edges(int cluster);
+
+	// BFS limited to one cluster, result in m_local_distances / m_local_parents
+	void search_cluster(int cluster, int start_cell);
+	int local_distance(int cluster, int cell) const;
+	void refine(int cluster, int end_cell, std::vector<int> & cells);
+
+	int m_nb_cols{ 0 };
+	int m_nb_rows{ 0 };
+	int m_cluster_size{ 1 };
+	int m_nb_cluster_cols{ 0 };
+	int m_nb_cluster_rows{ 0 };
+	std::vector<bool> m_wall_map;
+
+	std::vector<Node> m_nodes;
+	std::vector<int> m_free_nodes;
+	std::vector<std::vector<int>> m_cluster_nodes;
+	std::vector<Border> m_borders;
+
+	std::vector<int> m_local_distances;
+	std::vector<int> m_local_parents;
+	std::vector<int> m_local_queue;
+
+	Search_space m_search;
+};
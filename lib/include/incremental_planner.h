@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <memory>
+
+#include "game_structures.h"
+#include "collider_grid.h"
+
+// Per-agent LPA* planner rooted at the agent tile.
+// The search state is kept between calls : when the goal tile moves the open
+// list is re-keyed and only the missing part is expanded, when a collider
+// changes only the touched cells are repaired. The agent walking along its own
+// path needs no work at all ; leaving it restarts a search from its tile.
+class Incremental_planner
+{
+public:
+	static constexpr int infinity{ std::numeric_limits<int>::max() / 2 };
+
+	Incremental_planner();
+
+	void bind(Collider_grid const* colliders, size_t wall_revision);
+	bool is_bound_to(Collider_grid const* colliders) const;
+	// Replays the collider changes logged after the bound revision, the log
+	// starting at first_revision ; false if changes it needs were trimmed
+	bool apply_wall_changes(std::vector<Index> const& wall_changes, size_t first_revision);
+	// Revision replayed so far, for the owner of the log to know what it can trim
+	std::weak_ptr<size_t const> revision_lease() const;
+
+	void set_start(Index const& start);
+	void set_goal(Index const& goal);
+
+	// Expands at most max_expansions nodes ; false while the path is not up to date
+	bool compute(int max_expansions);
+
+	// Last complete path, goal first and agent tile last, empty if unreachable
+	std::vector<int> const& path() const;
+	bool is_up_to_date() const;
+	size_t expanded_nodes() const;
+	size_t full_searches() const;
+
+	~Incremental_planner();
+
+private:
+	int heuristic(int cell) const;
+	bool key_before(int cell_1, int cell_2) const;
+	void compute_key(int cell);
+
+	void heap_push(int cell);
+	void heap_remove(int cell);
+	int heap_pop();
+	void heap_sift_up(size_t heap_index);
+	void heap_sift_down(size_t heap_index);
+	void heap_place(size_t heap_index, int cell);
+	void rekey_heap();
+
+	int neighbor_cell(int cell, int direction) const;
+	void update_cell(int cell);
+	void update_around(int cell);
+	void reset_root();
+	bool repair(int max_expansions);
+	bool extract_path(std::vector<int> & cells) const;
+
+	int m_nb_cols{ 0 };
+	int m_nb_rows{ 0 };
+	Collider_grid const* m_colliders{ nullptr };
+	size_t m_wall_revision{ 0 };
+	std::shared_ptr<size_t> m_revision_lease;
+
+	int m_root{ -1 };
+	int m_position{ -1 };
+	int m_goal{ -1 };
+	bool m_dirty{ true };
+
+	std::vector<int> m_g;
+	std::vector<int> m_rhs;
+	std::vector<int> m_key_1;
+	std::vector<int> m_key_2;
+	std::vector<int> m_heap_index;
+	std::vector<int> m_heap;
+
+	std::vector<int> m_path;
+	size_t m_expanded_nodes{ 0 };
+	size_t m_full_searches{ 0 };
+};
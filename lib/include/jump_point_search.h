@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <array>
+
+#include "game_structures.h"
+#include "search_space.h"
+
+// Jump Point Search for a 4-connected grid with unit cost (JPS+ flavour).
+// Paths are canonical "horizontal first" : horizontal jumps look up and down
+// at every cell, vertical jumps stop on forced neighbors. Every jump distance
+// that does not depend on the goal is precomputed in rebuild().
+class Jump_point_search
+{
+public:
+	Jump_point_search();
+
+	void rebuild(int nb_cols, int nb_rows, std::vector<bool> const& wall_map);
+
+	// Cells from goal back to start, false if the goal cannot be reached
+	bool find_path(Index const& start, Index const& goal, std::vector<int> & cells);
+	size_t expanded_nodes() const;
+
+	~Jump_point_search();
+
+private:
+	enum Direction { left, right, up, down };
+
+	bool is_open(int x, int y) const;
+	int jump_horizontal(int x, int y, int dx, Index const& goal) const;
+	int jump_vertical(int x, int y, int dy, Index const& goal) const;
+	void push_jump(int from, int to, Index const& goal);
+
+	int m_nb_cols{ 0 };
+	int m_nb_rows{ 0 };
+	std::vector<bool> m_wall_map;
+
+	// Open cells in a straight line before a wall or the border
+	std::array<std::vector<int>, 4> m_runs;
+	// Steps to the next goal-independent jump point, 0 if none before the wall
+	std::array<std::vector<int>, 4> m_jumps;
+
+	Search_space m_search;
+	size_t m_expanded_nodes{ 0 };
+};
@@ -6,6 +6,16 @@
 #include <SFML/Graphics.hpp>
 
 #include "game_structures.h"
+#include "collider_grid.h"
+
+// Where Map::sweep stopped a box, and for each axis the normal of the wall that
+// blocked it : -1 or 1, 0 when the move on that axis was free
+struct Sweep_result
+{
+	Position position;
+	int normal_x{ 0 };
+	int normal_y{ 0 };
+};
 
 class Map
 {
@@ -16,15 +26,28 @@ public:
 	void draw_map(sf::RenderWindow & render_window);
 
 	bool check_collision(float x, float y, int w, int h);
+	// Moves the box by (dx, dy), x then y, up to the first wall in its way. Only
+	// the tile columns and rows the box enters are read : O(tiles crossed)
+	// whatever the speed, so a long frame cannot go through a wall
+	Sweep_result sweep(Position const& position, Size const& size, float dx, float dy) const;
+	// The collider map is rebuilt from the collider grid, the only copy Map keeps
 	Map_infos get_loaded_infos() const;
+	Collider_grid const& get_colliders() const;
+	Size get_tile_size() const;
 
 	~Map();
 
 private:
 	sf::Texture load_tileset(std::string const& tileset_path);
+	float sweep_x(float x, float y, Size const& size, float dx, int & normal) const;
+	float sweep_y(float x, float y, Size const& size, float dy, int & normal) const;
+	int tile_x(float x) const;
+	int tile_y(float y) const;
 
 	sf::Texture m_tileset;
 	sf::VertexArray m_vertex_map;
 
+	// Without its collider map : walls are read through m_colliders
 	Map_infos m_infos;
+	Collider_grid m_colliders;
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+
+// Path storage owned by the caller, allocated once by reserve then written in
+// place : filling it never allocates. The writer returns the path length,
+// positions are goal first and start last like A_star::create_center_path.
+class Path_buffer
+{
+public:
+	Path_buffer();
+	explicit Path_buffer(size_t capacity);
+
+	void reserve(size_t capacity);
+	size_t capacity() const;
+
+	Position * data();
+	Position const& operator[](size_t index) const;
+
+	~Path_buffer();
+
+private:
+	std::vector<Position> m_positions;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+
+// Last path found for one agent, reused until its goal tile changes, a collider
+// changes or the agent leaves it. Hits and misses are counted for profiling.
+class Path_cache
+{
+public:
+	Path_cache();
+
+	// Drops the part of the path behind start_cell, false if the path cannot be reused
+	bool advance(int start_cell, int goal_cell, size_t collider_revision);
+	void store(std::vector<Position> const& path, std::vector<int> const& cells, int goal_cell, size_t collider_revision);
+
+	// Goal first and start last, like A_star::create_center_path
+	std::vector<Position> const& path() const;
+
+	size_t hits() const;
+	size_t misses() const;
+	void clear();
+
+	~Path_cache();
+
+private:
+	std::vector<Position> m_path;
+	std::vector<int> m_cells;
+	int m_goal_cell{ -1 };
+	size_t m_collider_revision{ 0 };
+
+	size_t m_hits{ 0 };
+	size_t m_misses{ 0 };
+};
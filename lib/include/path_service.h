@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+#include "game_structures.h"
+#include "entity.h"
+#include "search_space.h"
+#include "collider_grid.h"
+
+// Path requests answered by a fixed pool of worker threads.
+// Each request carries a read-only snapshot of the collider map taken when it
+// was submitted ; changing a collider publishes a new snapshot for the next
+// requests without touching the running ones. The caller polls its ticket in a
+// later frame and keeps its old path meanwhile.
+class Path_service
+{
+public:
+	using Ticket = std::uint64_t;
+	static constexpr Ticket no_ticket{ 0 };
+
+	Path_service(Map_infos const& infos, size_t nb_workers);
+	Path_service(Path_service const&) = delete;
+	Path_service & operator=(Path_service const&) = delete;
+
+	void set_collider(Index const& index, bool wall);
+
+	Ticket submit(ecs::Id const& agent, Position const& start, Position const& goal);
+	// True once the path is ready, goal first like A_star::create_center_path.
+	// A result is handed over only once.
+	bool poll(Ticket const& ticket, std::vector<Position> & path);
+	// Drops queued requests and results of the agents matching the predicate
+	void cancel_if(std::function<bool(ecs::Id const&)> const& predicate);
+
+	size_t pending() const;
+	Index tile_of(Position const& position) const;
+
+	~Path_service();
+
+private:
+	struct Snapshot
+	{
+		Size tile_size;
+		Collider_grid colliders;
+	};
+
+	struct Request
+	{
+		Ticket ticket;
+		ecs::Id agent;
+		Position start;
+		Position goal;
+		std::shared_ptr<const Snapshot> snapshot;
+	};
+
+	struct Result
+	{
+		ecs::Id agent;
+		bool done;
+		std::vector<Position> path;
+	};
+
+	void work();
+	static std::vector<Position> search(Snapshot const& snapshot, Search_space & search_space, Position const& start, Position const& goal);
+
+	Size m_tile_size;
+	std::shared_ptr<const Snapshot> m_snapshot;
+
+	std::deque<Request> m_requests;
+	// Every request not handed over yet, running or done
+	std::unordered_map<Ticket, Result> m_results;
+	Ticket m_next_ticket{ 1 };
+	bool m_stopping{ false };
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::vector<std::thread> m_workers;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <cassert>
+
+#include "entity.h"
+#include "sparse_set.h"
+#include "view.h"
+
+namespace ecs
+{
+	// Owns the entity pool and one Sparse_set per component type.
+	// Every pool is a tuple element picked by type at compile time : adding a
+	// component type only means adding it to the template argument list.
+	template <typename... Components>
+	class Registry
+	{
+	public:
+		Id create()
+		{
+			return m_entities.create();
+		}
+
+		bool alive(Id const& id) const
+		{
+			return m_entities.alive(id);
+		}
+
+		size_t size() const
+		{
+			return m_entities.size();
+		}
+
+		template <typename Component>
+		void add(Component const& component)
+		{
+			assert(alive(component.id_data));
+			pool<Component>().push_back(component);
+		}
+
+		template <typename Component>
+		bool remove(Id const& id)
+		{
+			return pool<Component>().erase(id);
+		}
+
+		bool destroy(Id const& id)
+		{
+			if (!m_entities.destroy(id))
+			{
+				return false;
+			}
+
+			(pool<Components>().erase(id), ...);
+
+			return true;
+		}
+
+		// Drops dead ids and duplicates from ids, then sweeps each pool once.
+		// ids holds the destroyed entities on return.
+		void destroy(std::vector<Id> & ids)
+		{
+			auto alive_end{ std::remove_if(ids.begin(), ids.end(),
+				[this](Id const& id) {return !m_entities.destroy(id); }) };
+			ids.erase(alive_end, ids.end());
+
+			(erase_all(pool<Components>(), ids), ...);
+		}
+
+		template <typename Component>
+		Sparse_set<Component> & pool()
+		{
+			return std::get<Sparse_set<Component>>(m_pools);
+		}
+
+		template <typename Component>
+		Sparse_set<Component> const& pool() const
+		{
+			return std::get<Sparse_set<Component>>(m_pools);
+		}
+
+		template <typename Component>
+		bool has(Id const& id) const
+		{
+			return pool<Component>().contains(id);
+		}
+
+		template <typename Component>
+		Component & get(Id const& id)
+		{
+			return pool<Component>().get(id);
+		}
+
+		template <typename Component>
+		Component * try_get(Id const& id)
+		{
+			return pool<Component>().find(id);
+		}
+
+		template <typename... Included>
+		View<std::tuple<Sparse_set<Included>...>> view()
+		{
+			return ecs::view(pool<Included>()...);
+		}
+
+		void clear()
+		{
+			m_entities.clear();
+			(pool<Components>().clear(), ...);
+		}
+
+	private:
+		template <typename Pool>
+		static void erase_all(Pool & pool, std::vector<Id> const& ids)
+		{
+			for (auto const& id : ids)
+			{
+				pool.erase(id);
+			}
+		}
+
+		Entity_pool m_entities;
+		std::tuple<Sparse_set<Components>...> m_pools;
+	};
+}
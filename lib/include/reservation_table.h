@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "entity.h"
+
+// Space-time reservations for cooperative planning : a tile is held by one
+// agent at a given step. Steps count tile moves from the planning frame.
+// One slot per (step, tile), stamped with the generation of the frame that
+// wrote it like Search_space, so clearing never touches the slots.
+class Reservation_table
+{
+public:
+	Reservation_table();
+
+	// Room for steps [0, nb_steps) on a map of nb_cells tiles ; drops every reservation
+	void resize(size_t nb_cells, int nb_steps);
+	size_t nb_cells() const;
+	int nb_steps() const;
+
+	void clear();
+
+	// False if another agent already holds the tile at that step, or the step is out of the table
+	bool reserve(int cell, int step, ecs::Id const& agent);
+	bool is_free(int cell, int step, ecs::Id const& agent) const;
+	// Moving from -> to between step - 1 and step swaps places with another agent
+	bool crosses(int from, int to, int step, ecs::Id const& agent) const;
+
+	size_t size() const;
+
+	~Reservation_table();
+
+private:
+	struct Slot
+	{
+		unsigned int stamp{ 0 };
+		ecs::Id owner{ ecs::null_entity };
+	};
+
+	bool is_inside(int cell, int step) const;
+	ecs::Id owner(int cell, int step) const;
+
+	size_t m_nb_cells{ 0 };
+	int m_nb_steps{ 0 };
+	std::vector<Slot> m_slots;
+	unsigned int m_generation{ 1 };
+	size_t m_size{ 0 };
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+struct Search_node
+{
+	unsigned int stamp{ 0 };
+	int g{ 0 };
+	int f{ 0 };
+	int parent{ -1 };
+	int heap_index{ -1 };
+};
+
+// Per-cell search state plus an indexed binary heap used as open set.
+// Cells are stamped with the generation of the search that touched them, so
+// starting a new search never has to clear the arrays.
+class Search_space
+{
+public:
+	static constexpr int closed{ -1 };
+
+	void resize(size_t nb_nodes);
+	size_t size() const;
+
+	void begin_search();
+
+	bool visited(int node) const;
+	bool is_open(int node) const;
+	bool is_closed(int node) const;
+
+	Search_node & node(int node);
+	Search_node const& node(int node) const;
+
+	// Push the node, or lower its cost if already open and g is better
+	// Returns false when nothing changed
+	bool open(int node, int g, int f, int parent);
+	// Lowest f first, ties broken on highest g ; the node is closed
+	int pop();
+	int top() const;
+	bool empty() const;
+
+private:
+	bool before(int node_1, int node_2) const;
+	void sift_up(size_t heap_index);
+	void sift_down(size_t heap_index);
+	void place(size_t heap_index, int node);
+
+	std::vector<Search_node> m_nodes;
+	std::vector<int> m_heap;
+	unsigned int m_generation{ 0 };
+};
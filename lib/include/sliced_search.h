@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+#include "collider_grid.h"
+#include "search_space.h"
+
+// A* search that can be spread over several frames : step() expands at most
+// budget nodes and returns, the state is kept until the next call.
+class Sliced_search
+{
+public:
+	enum class State { idle, running, found, failed };
+
+	Sliced_search();
+
+	// revision : caller tag for the map state the search was started on
+	void start(Collider_grid const* colliders, size_t revision, Index const& start, Index const& goal);
+	// Returns the number of nodes expanded
+	int step(int budget);
+	void cancel();
+
+	State state() const;
+	bool is_running() const;
+	size_t revision() const;
+	// Cells from goal back to start once found
+	bool extract_path(std::vector<int> & cells) const;
+
+	~Sliced_search();
+
+private:
+	Collider_grid const* m_colliders{ nullptr };
+	size_t m_revision{ 0 };
+
+	Index m_goal{ 0, 0 };
+	int m_goal_cell{ -1 };
+	State m_state{ State::idle };
+
+	Search_space m_search;
+};
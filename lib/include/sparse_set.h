@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <utility>
+
+#include "entity.h"
+
+namespace ecs
+{
+	// Component storage keyed on the component's id_data.
+	// Components are packed in a dense vector (contiguous iteration) and a sparse
+	// table maps an entity index to its slot, so lookup, insert and erase are O(1).
+	// A stale id (same index, older generation) is not found.
+	// Erase moves the last component into the freed slot : order is not kept.
+	template <typename Component>
+	class Sparse_set
+	{
+	public:
+		using value_type = Component;
+		using iterator = typename std::vector<Component>::iterator;
+		using const_iterator = typename std::vector<Component>::const_iterator;
+
+		static constexpr size_t npos{ static_cast<size_t>(-1) };
+
+		void push_back(Component const& component)
+		{
+			const size_t key{ entity_index(component.id_data) };
+			assert(!contains(component.id_data));
+
+			if (key >= m_sparse.size())
+			{
+				m_sparse.resize(key + 1, npos);
+			}
+
+			m_sparse[key] = m_dense.size();
+			m_dense.push_back(component);
+		}
+
+		bool erase(Id const& id)
+		{
+			if (!contains(id))
+			{
+				return false;
+			}
+
+			const size_t key{ entity_index(id) };
+			const size_t slot{ m_sparse[key] };
+
+			if (slot != m_dense.size() - 1)
+			{
+				m_dense[slot] = std::move(m_dense.back());
+				m_sparse[entity_index(m_dense[slot].id_data)] = slot;
+			}
+
+			m_dense.pop_back();
+			m_sparse[key] = npos;
+
+			return true;
+		}
+
+		bool contains(Id const& id) const
+		{
+			const size_t key{ entity_index(id) };
+			return key < m_sparse.size() && m_sparse[key] != npos && m_dense[m_sparse[key]].id_data == id;
+		}
+
+		Component * find(Id const& id)
+		{
+			return contains(id) ? &m_dense[m_sparse[entity_index(id)]] : nullptr;
+		}
+
+		Component const* find(Id const& id) const
+		{
+			return contains(id) ? &m_dense[m_sparse[entity_index(id)]] : nullptr;
+		}
+
+		Component & get(Id const& id)
+		{
+			assert(contains(id));
+			return m_dense[m_sparse[entity_index(id)]];
+		}
+
+		Component const& get(Id const& id) const
+		{
+			assert(contains(id));
+			return m_dense[m_sparse[entity_index(id)]];
+		}
+
+		void clear()
+		{
+			m_dense.clear();
+			m_sparse.clear();
+		}
+
+		void reserve(size_t capacity)
+		{
+			m_dense.reserve(capacity);
+		}
+
+		size_t size() const { return m_dense.size(); }
+		bool empty() const { return m_dense.empty(); }
+
+		iterator begin() { return m_dense.begin(); }
+		iterator end() { return m_dense.end(); }
+		const_iterator begin() const { return m_dense.begin(); }
+		const_iterator end() const { return m_dense.end(); }
+
+	private:
+		std::vector<Component> m_dense;
+		std::vector<size_t> m_sparse;
+	};
+}
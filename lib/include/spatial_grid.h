@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "game_structures.h"
+#include "entity.h"
+
+// Uniform grid broadphase, one cell per map tile.
+// An entity is stored in every cell its box covers ; moving it only touches the
+// grid when the covered cell range changes.
+class Spatial_grid
+{
+public:
+	Spatial_grid(Map_infos const& infos);
+
+	void insert(ecs::Id const& id, Position const& pos, Size const& size);
+	void update(ecs::Id const& id, Position const& pos, Size const& size);
+	bool remove(ecs::Id const& id);
+	bool contains(ecs::Id const& id) const;
+
+	// Every entity sharing a cell with the box, each reported once
+	void query(Position const& pos, Size const& size, std::vector<ecs::Id> & result);
+	// Every pair of entities sharing a cell, each pair reported once
+	void find_pairs(std::vector<std::pair<ecs::Id, ecs::Id>> & result) const;
+
+	void clear();
+
+	~Spatial_grid();
+
+private:
+	struct Cell_range
+	{
+		int x1;
+		int y1;
+		int x2;
+		int y2;
+	};
+
+	struct Record
+	{
+		ecs::Id id{ ecs::null_entity };
+		Cell_range range;
+		unsigned int stamp{ 0 };
+	};
+
+	Cell_range get_cell_range(Position const& pos, Size const& size) const;
+	Record * find_record(ecs::Id const& id);
+	void link(ecs::Id const& id, Cell_range const& range);
+	void unlink(ecs::Id const& id, Cell_range const& range);
+
+	int m_nb_rows;
+	int m_nb_cols;
+	Size m_cell_size;
+
+	std::vector<std::vector<ecs::Id>> m_cells;
+	std::vector<Record> m_records;
+	unsigned int m_query_stamp{ 0 };
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "game_structures.h"
+#include "entity.h"
+
+// Pair of entities that began or stopped overlapping
+struct Overlap_event
+{
+	ecs::Id first;
+	ecs::Id second;
+	bool begin;
+};
+
+// Sort and sweep broadphase : box endpoints kept sorted on x and y between
+// frames. Boxes barely move from one frame to the next, so sorting again is an
+// insertion sort touching few endpoints, and each swap updates the pairs it
+// concerns instead of recomputing them all. Same overlap test as
+// ecs::check_collision, edges touching is no overlap.
+class Sweep_and_prune
+{
+public:
+	Sweep_and_prune();
+
+	// Inserts the box if the entity is not there yet ; sorted on the next sweep
+	void update(ecs::Id const& id, Position const& pos, Size const& size);
+	// Its overlaps end, reported on the next sweep
+	bool remove(ecs::Id const& id);
+	bool contains(ecs::Id const& id) const;
+
+	// Sorts the endpoints again and adds the overlaps that began or ended since
+	// the last sweep to events
+	void sweep(std::vector<Overlap_event> & events);
+	// Pairs overlapping as of the last sweep
+	std::vector<std::pair<ecs::Id, ecs::Id>> const& overlaps() const;
+
+	size_t size() const;
+	void clear();
+
+	~Sweep_and_prune();
+
+private:
+	struct Endpoint
+	{
+		float value;
+		std::uint32_t index;
+		bool is_max;
+	};
+
+	struct Record
+	{
+		ecs::Id id{ ecs::null_entity };
+		// Place of the min and max endpoints on each axis
+		size_t endpoints[2][2];
+	};
+
+	struct Pair_state
+	{
+		// Axes on which the two boxes overlap
+		int axes{ 0 };
+		bool reported{ false };
+		bool changed{ false };
+		size_t overlap{ 0 };
+	};
+
+	static bool before(Endpoint const& a, Endpoint const& b);
+	static std::uint64_t pair_key(std::uint32_t index_1, std::uint32_t index_2);
+
+	Record * find_record(ecs::Id const& id);
+	void set_endpoint(int axis, size_t place, Endpoint const& endpoint);
+	void sort_axis(int axis);
+	// The endpoint at place passes the one before it
+	void swap_down(int axis, size_t place);
+	void change_axes(std::uint32_t index_1, std::uint32_t index_2, int delta);
+	void report(std::vector<Overlap_event> & events);
+
+	std::vector<Endpoint> m_axes[2];
+	std::vector<Record> m_records;
+	std::unordered_map<std::uint64_t, Pair_state> m_pairs;
+	std::vector<std::uint64_t> m_changed;
+	std::vector<std::pair<ecs::Id, ecs::Id>> m_overlaps;
+	// Ends of the overlaps of removed boxes, waiting for the next sweep
+	std::vector<Overlap_event> m_pending;
+	size_t m_size{ 0 };
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "game_structures.h"
+#include "entity.h"
+
+// Lookup table for entities that never move (points).
+// Each entity is filed under the tile holding its center, so a query only reads
+// the few tiles under the box (grown by the largest half size registered) and
+// remove is a swap-and-pop in that tile.
+class Tile_index
+{
+public:
+	Tile_index(Map_infos const& infos);
+
+	void insert(ecs::Id const& id, Position const& pos, Size const& size);
+	bool remove(ecs::Id const& id);
+	bool contains(ecs::Id const& id) const;
+
+	// Entities whose center tile can hold a box overlapping the given one
+	void query(Position const& pos, Size const& size, std::vector<ecs::Id> & result) const;
+
+	size_t size() const;
+	void clear();
+
+	~Tile_index();
+
+private:
+	struct Record
+	{
+		ecs::Id id{ ecs::null_entity };
+		int tile{ -1 };
+		size_t slot{ 0 };
+	};
+
+	int get_tile(float x, float y) const;
+
+	int m_nb_rows;
+	int m_nb_cols;
+	Size m_tile_size;
+	Size m_max_half_size{ 0, 0 };
+
+	std::vector<std::vector<ecs::Id>> m_tiles;
+	std::vector<Record> m_records;
+	size_t m_size{ 0 };
+};
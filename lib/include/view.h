@@ -0,0 +1,100 @@
+#pragma once
+
+#include <tuple>
+#include <cstddef>
+#include <utility>
+
+#include "entity.h"
+
+namespace ecs
+{
+	template <typename Included, typename Excluded = std::tuple<>>
+	class View;
+
+	// Join over several pools (anything with size, begin/end, contains and get).
+	// each() walks the smallest included pool and probes the others in O(1),
+	// skipping entities found in one of the excluded pools.
+	template <typename... Pools, typename... Excluded>
+	class View<std::tuple<Pools...>, std::tuple<Excluded...>>
+	{
+		static_assert(sizeof...(Pools) > 0, "A view needs at least one pool");
+
+	public:
+		View(std::tuple<Pools&...> const& pools, std::tuple<Excluded const&...> const& excluded) :
+			m_pools{ pools },
+			m_excluded{ excluded }
+		{}
+
+		template <typename... Others>
+		View<std::tuple<Pools...>, std::tuple<Excluded..., Others...>> exclude(Others const&... others) const
+		{
+			return { m_pools, std::tuple_cat(m_excluded, std::tuple<Others const&...>{ others... }) };
+		}
+
+		bool contains(Id const& id) const
+		{
+			return std::apply([&id](auto &... pools) { return (pools.contains(id) && ...); }, m_pools)
+				&& !std::apply([&id](auto const&... pools) { return (pools.contains(id) || ...); }, m_excluded);
+		}
+
+		// Upper bound of the number of entities visited
+		size_t size_hint() const
+		{
+			size_t result{ static_cast<size_t>(-1) };
+			std::apply([&result](auto &... pools) { ((result = pools.size() < result ? pools.size() : result), ...); }, m_pools);
+
+			return result;
+		}
+
+		// function(Id const&, Pools::value_type&...)
+		template <typename Function>
+		void each(Function && function)
+		{
+			const size_t smallest{ smallest_pool() };
+			size_t index{ 0 };
+
+			std::apply([&](auto &... pools)
+			{
+				((index++ == smallest ? visit(pools, function) : void()), ...);
+			}, m_pools);
+		}
+
+	private:
+		size_t smallest_pool() const
+		{
+			size_t smallest{ 0 };
+			size_t smallest_size{ static_cast<size_t>(-1) };
+			size_t index{ 0 };
+
+			std::apply([&](auto &... pools)
+			{
+				((pools.size() < smallest_size ? (smallest = index, smallest_size = pools.size(), index++) : index++), ...);
+			}, m_pools);
+
+			return smallest;
+		}
+
+		template <typename Pool, typename Function>
+		void visit(Pool & driver, Function & function)
+		{
+			for (auto & component : driver)
+			{
+				const Id id{ component.id_data };
+
+				if (contains(id))
+				{
+					std::apply([&](auto &... pools) { function(id, pools.get(id)...); }, m_pools);
+				}
+			}
+		}
+
+		std::tuple<Pools&...> m_pools;
+		std::tuple<Excluded const&...> m_excluded;
+	};
+
+	template <typename... Pools>
+	View<std::tuple<Pools...>> view(Pools &... pools)
+	{
+		return { std::tuple<Pools&...>{ pools... }, std::tuple<>{} };
+	}
+}
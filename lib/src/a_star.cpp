@@ -3,28 +3,14 @@
 #include <functional>
 #include <cmath>
 #include <algorithm>
+#include <thread>
 
 #include "a_star.h"
+#include "grid_search.h"
+#include "path_service.h"
 
-int heuristic(Spot const& a, Spot const& b)
-{
-	return std::abs(a.spot_index.x - b.spot_index.x) + std::abs(a.spot_index.y - b.spot_index.y);
-}
-
-inline bool operator==(Spot const& struct_1,  Spot const& struct_2)
-{
-	return struct_1.spot_index.y == struct_2.spot_index.y && struct_1.spot_index.x == struct_2.spot_index.x;
-}
-
-std::vector<Spot>::iterator find(Spot & target, std::vector<Spot> & container)
-{
-	return std::find(container.begin(), container.end(), target);
-}
-
-bool is_in(std::vector<Spot> & container, Spot & target)
-{
-	return (find(target, container) != container.end());
-}
+const int cluster_size{ 16 };
+const int incremental_budget{ 1024 };
 
 Position index_to_coord(Index const& target, Size const& Size)
 {
@@ -43,189 +29,864 @@ void A_star::load_map_infos(Map_infos const& infos)
 	m_nb_rows = infos.nb_rows;
 	m_tile_size = infos.tile_size;
 
-	m_wall_map = infos.collider_map;
+	m_colliders = Collider_grid{ infos.nb_cols, infos.nb_rows, infos.collider_map };
 }
 
 void A_star::create_spots()
 {
 	std::cout << "Starting create spot (A*)" << std::endl;
-	for (int y{ 0 }; y < m_nb_rows; y++)
-	{
-		for (int x{ 0 }; x < m_nb_cols; x++)
-		{
-			m_spot_map.push_back(
-				Spot{ Index{x, y}, 0, 0, 0, m_wall_map[y * m_nb_cols + x] }
-			);
+	const std::vector<bool> wall_map{ m_colliders.to_wall_map() };
 
-		}
-	}
+	m_search.resize(m_colliders.nb_cells());
+	m_jump_search.rebuild(m_nb_cols, m_nb_rows, wall_map);
+	m_hierarchical_path.rebuild(m_nb_cols, m_nb_rows, wall_map, cluster_size);
 
 	std::cout << "Spot created (A*)" << std::endl;
 }
 
-Index A_star::get_corresponding_index(float x, float y)
+Index A_star::get_corresponding_index(float x, float y) const
 {
 	return Index{ static_cast<int>(std::floor(x / m_tile_size.width)), static_cast<int>(std::floor(y / m_tile_size.height)) };
 }
 
-std::vector<Position> A_star::extract_path(std::vector<Spot> & close_set)
+bool A_star::is_inside(Index const& index) const
+{
+	return index.x >= 0 && index.y >= 0 && index.x < m_nb_cols && index.y < m_nb_rows;
+}
+
+Position A_star::cell_center(int cell) const
+{
+	return get_center(index_to_coord(Index{ cell % m_nb_cols, cell / m_nb_cols }, m_tile_size), m_tile_size);
+}
+
+std::vector<Position> A_star::extract_path(int goal_cell)
 {
 	std::vector<Position> path;
-	Spot temp{ close_set.back() };
-	path.push_back( get_center(index_to_coord(temp.spot_index, m_tile_size), m_tile_size) );
 
-	while (temp.parent != -1)
+	for (int cell{ goal_cell }; cell != -1; cell = m_search.node(cell).parent)
 	{
-		path.push_back( get_center(index_to_coord(close_set[temp.parent].spot_index, m_tile_size), m_tile_size) );
-		temp = close_set[temp.parent];
+		path.push_back( cell_center(cell) );
 	}
 
 	return path;
 }
 
+size_t A_star::write_search_path(Path_buffer & buffer, int goal_cell) const
+{
+	size_t length{ 0 };
+	for (int cell{ goal_cell }; cell != -1; cell = m_search.node(cell).parent)
+	{
+		length++;
+	}
+
+	if (length > buffer.capacity())
+	{
+		return 0;
+	}
+
+	Position * positions{ buffer.data() };
+	for (int cell{ goal_cell }; cell != -1; cell = m_search.node(cell).parent)
+	{
+		*positions++ = cell_center(cell);
+	}
+
+	return length;
+}
+
+// Path from the goal center back to the start center, empty if the goal cannot be reached
 std::vector<Position> A_star::create_center_path(float x_1, float y_1, float x_2, float y_2)
 {
 	Index b_index{ get_corresponding_index(x_1, y_1) };
 	Index e_index{ get_corresponding_index(x_2, y_2) };
 
-	std::vector<Spot> open_set;
-	open_set.push_back(m_spot_map[ b_index.y * m_nb_cols + b_index.x ]);
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return {};
+	}
 
-	std::vector<Spot> close_set;
+	const int goal_cell{ e_index.y * m_nb_cols + e_index.x };
 
-	bool finish{ false };
+	if (goal_cell == m_flow_target)
+	{
+		return extract_flow_path(b_index.y * m_nb_cols + b_index.x);
+	}
 
-	while (!finish)
+	if (m_distance_table.is_built())
 	{
-		size_t lowest_index{ 0 };
-		for (size_t i{ 0 }; i < open_set.size(); i++)
+		std::vector<int> cells;
+		m_distance_table.find_path(b_index.y * m_nb_cols + b_index.x, goal_cell, cells);
+
+		return cells_to_path(cells);
+	}
+
+	if (find_grid_path(m_search, m_colliders, b_index, e_index))
+	{
+		return extract_path(goal_cell);
+	}
+
+	return {};
+}
+
+// create_center_path without the allocation : every branch writes in place
+size_t A_star::write_center_path(Path_buffer & buffer, float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return 0;
+	}
+
+	const int start_cell{ b_index.y * m_nb_cols + b_index.x };
+	const int goal_cell{ e_index.y * m_nb_cols + e_index.x };
+
+	if (goal_cell == m_flow_target)
+	{
+		return write_flow_path(buffer, start_cell);
+	}
+
+	if (m_distance_table.is_built())
+	{
+		m_table_cells.clear();
+		m_distance_table.find_path(start_cell, goal_cell, m_table_cells);
+
+		return write_cells(buffer, m_table_cells);
+	}
+
+	if (find_grid_path(m_search, m_colliders, b_index, e_index))
+	{
+		return write_search_path(buffer, goal_cell);
+	}
+
+	return 0;
+}
+
+// A shortest path never goes through a cell twice
+size_t A_star::max_path_length() const
+{
+	return m_colliders.nb_cells();
+}
+
+void A_star::set_batch_threads(size_t nb_threads)
+{
+	m_batch_max_threads = nb_threads;
+}
+
+void A_star::batch_thread(size_t index, size_t round)
+{
+	while (true)
+	{
+		std::vector<Path_query> const* queries;
+		bool has_share;
+		size_t first;
+		size_t last;
 		{
-			if (open_set[i].f < open_set[lowest_index].f)
+			std::unique_lock<std::mutex> lock{ m_batch_mutex };
+			m_batch_wake.wait(lock, [this, round] { return m_batch_stopping || m_batch_round != round; });
+
+			if (m_batch_stopping)
 			{
-				lowest_index = i;
+				return;
 			}
+
+			round = m_batch_round;
+			queries = m_batch_queries;
+			// A smaller batch leaves the last threads without a share
+			has_share = index < m_batch_shares;
+			first = std::min(queries->size(), index * m_batch_queries_per_share);
+			last = std::min(queries->size(), first + m_batch_queries_per_share);
 		}
 
-		if (open_set[lowest_index] == m_spot_map[e_index.y * m_nb_cols + e_index.x])
+		if (has_share)
 		{
-			close_set.push_back( open_set[lowest_index] );
+			run_batch(m_batch_workers[index], *queries, first, last);
+		}
 
-			return extract_path(close_set);
+		std::lock_guard<std::mutex> lock{ m_batch_mutex };
+		if (--m_batch_running == 0)
+		{
+			m_batch_done.notify_one();
 		}
+	}
+}
 
-		close_set.push_back( open_set[lowest_index] );
-		auto remove_it{ std::remove(open_set.begin(), open_set.end(), open_set[lowest_index]) };
-		open_set.erase(remove_it, open_set.end());
+void A_star::run_batch(Batch_worker & worker, std::vector<Path_query> const& queries, size_t first, size_t last) const
+{
+	worker.positions.clear();
+	worker.lengths.clear();
 
-		Spot & winner{ close_set.back() };
+	if (worker.search.size() != m_colliders.nb_cells())
+	{
+		worker.search.resize(m_colliders.nb_cells());
+	}
 
-		if (winner.spot_index.x > 0)
+	for (size_t i{ first }; i < last; i++)
+	{
+		const Index b_index{ get_corresponding_index(queries[i].start.x, queries[i].start.y) };
+		const Index e_index{ get_corresponding_index(queries[i].goal.x, queries[i].goal.y) };
+
+		const size_t begin{ worker.positions.size() };
+
+		if (is_inside(b_index) && is_inside(e_index) && find_grid_path(worker.search, m_colliders, b_index, e_index))
 		{
-			Spot neighbor{ m_spot_map[ winner.spot_index.y * m_nb_cols + (winner.spot_index.x - 1) ] };
-			if (!is_in(close_set, neighbor) && !neighbor.wall)
+			for (int cell{ e_index.y * m_nb_cols + e_index.x }; cell != -1; cell = worker.search.node(cell).parent)
 			{
-				int g_temp{ winner.g + 1 };
-				if (is_in(open_set, neighbor))
-				{
-					Spot & neighbor_close = *find(neighbor, open_set); //CARE ABOUT THIS, REMPLACE ALL
-					if (g_temp < neighbor_close.g) { neighbor_close.g = g_temp; };
-
-					neighbor_close.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor_close.f = neighbor.h + neighbor.g;
-					neighbor_close.parent = close_set.size() - 1;
-				}
-				else
-				{
-					neighbor.g = g_temp;
-					neighbor.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor.f = neighbor.h + neighbor.g;
-					neighbor.parent = close_set.size() - 1;
-					open_set.push_back(neighbor);
-				}
-
+				worker.positions.push_back(cell_center(cell));
 			}
 		}
-		if (winner.spot_index.x < m_nb_cols - 1)
+
+		worker.lengths.push_back(worker.positions.size() - begin);
+	}
+}
+
+void A_star::find_paths(std::vector<Path_query> const& queries, Path_batch & result)
+{
+	const size_t queries_per_thread_min{ 8 };
+	const size_t max_threads{ m_batch_max_threads != 0 ? m_batch_max_threads : std::thread::hardware_concurrency() };
+	const size_t nb_threads{ std::max<size_t>(1, std::min<size_t>(max_threads, queries.size() / queries_per_thread_min)) };
+	const size_t queries_per_thread{ (queries.size() + nb_threads - 1) / nb_threads };
+
+	if (m_batch_workers.size() < nb_threads)
+	{
+		m_batch_workers.resize(nb_threads);
+	}
+
+	// Workers only read the map and write their own scratch
+	if (nb_threads > 1)
+	{
+		std::lock_guard<std::mutex> lock{ m_batch_mutex };
+
+		while (m_batch_threads.size() + 1 < nb_threads)
 		{
-			Spot neighbor{ m_spot_map[winner.spot_index.y * m_nb_cols + (winner.spot_index.x + 1)] };
-			if (!is_in(close_set, neighbor) && !neighbor.wall)
-			{
-				int g_temp{ winner.g + 1 };
-				if (is_in(open_set, neighbor))
-				{
-					Spot & neighbor_close = *find(neighbor, open_set); //CARE ABOUT THIS, REMPLACE ALL
-					if (g_temp < neighbor_close.g) { neighbor_close.g = g_temp; };
-
-					neighbor_close.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor_close.f = neighbor.h + neighbor.g;
-					neighbor_close.parent = close_set.size() - 1;
-				}
-				else
-				{
-					neighbor.g = g_temp;
-					neighbor.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor.f = neighbor.h + neighbor.g;
-					neighbor.parent = close_set.size() - 1;
-					open_set.push_back(neighbor);
-				}
+			m_batch_threads.emplace_back(&A_star::batch_thread, this, m_batch_threads.size() + 1, m_batch_round);
+		}
 
-			}
+		m_batch_queries = &queries;
+		m_batch_shares = nb_threads;
+		m_batch_queries_per_share = queries_per_thread;
+		m_batch_running = m_batch_threads.size();
+		m_batch_round++;
+		m_batch_wake.notify_all();
+	}
+
+	run_batch(m_batch_workers[0], queries, 0, std::min(queries.size(), queries_per_thread));
+
+	if (nb_threads > 1)
+	{
+		std::unique_lock<std::mutex> lock{ m_batch_mutex };
+		m_batch_done.wait(lock, [this] { return m_batch_running == 0; });
+	}
+
+	size_t total{ 0 };
+	for (size_t i{ 0 }; i < nb_threads; i++)
+	{
+		total += m_batch_workers[i].positions.size();
+	}
+
+	result.positions.resize(total);
+	result.offsets.resize(queries.size() + 1);
+
+	size_t query{ 0 };
+	size_t offset{ 0 };
+	for (size_t i{ 0 }; i < nb_threads; i++)
+	{
+		Batch_worker const& worker{ m_batch_workers[i] };
+
+		std::copy(worker.positions.begin(), worker.positions.end(), result.positions.begin() + offset);
+		for (auto const& length : worker.lengths)
+		{
+			result.offsets[query++] = offset;
+			offset += length;
 		}
-		if (winner.spot_index.y > 0)
+	}
+	result.offsets[query] = offset;
+}
+
+std::vector<Position> A_star::create_jump_path(float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return {};
+	}
+
+	std::vector<int> cells;
+	if (!m_jump_search.find_path(b_index, e_index, cells))
+	{
+		return {};
+	}
+
+	return cells_to_path(cells);
+}
+
+std::vector<Position> A_star::create_hierarchical_path(float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return {};
+	}
+
+	std::vector<int> cells;
+	if (!m_hierarchical_path.find_path(b_index, e_index, cells))
+	{
+		return {};
+	}
+
+	return cells_to_path(cells);
+}
+
+std::vector<Position> A_star::create_incremental_path(Incremental_planner & planner, float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return {};
+	}
+
+	// A planner behind the trimmed part of the log starts over
+	if (!planner.is_bound_to(&m_colliders) || !planner.apply_wall_changes(m_collider_changes, m_collider_log_base))
+	{
+		planner.bind(&m_colliders, m_collider_revision);
+		m_planner_revisions.push_back(planner.revision_lease());
+	}
+	trim_collider_changes();
+
+	planner.set_start(b_index);
+	planner.set_goal(e_index);
+	planner.compute(incremental_budget);
+
+	return cells_to_path(planner.path());
+}
+
+std::vector<Position> A_star::create_cached_path(Path_cache & cache, float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		return {};
+	}
+
+	const int start_cell{ b_index.y * m_nb_cols + b_index.x };
+	const int goal_cell{ e_index.y * m_nb_cols + e_index.x };
+
+	if (cache.advance(start_cell, goal_cell, m_collider_revision))
+	{
+		return cache.path();
+	}
+
+	std::vector<Position> path{ create_center_path(x_1, y_1, x_2, y_2) };
+
+	std::vector<int> cells;
+	cells.reserve(path.size());
+	for (auto const& position : path)
+	{
+		const Index index{ get_corresponding_index(position.x, position.y) };
+		cells.push_back(index.y * m_nb_cols + index.x);
+	}
+
+	cache.store(path, cells, goal_cell, m_collider_revision);
+
+	return path;
+}
+
+bool A_star::start_sliced_search(Sliced_search & search, float x_1, float y_1, float x_2, float y_2)
+{
+	Index b_index{ get_corresponding_index(x_1, y_1) };
+	Index e_index{ get_corresponding_index(x_2, y_2) };
+
+	if (!is_inside(b_index) || !is_inside(e_index))
+	{
+		search.cancel();
+		return false;
+	}
+
+	search.start(&m_colliders, m_collider_revision, b_index, e_index);
+	return true;
+}
+
+bool A_star::sliced_search_path(Sliced_search const& search, std::vector<Position> & path) const
+{
+	const auto state{ search.state() };
+	if (state == Sliced_search::State::idle || state == Sliced_search::State::running || search.revision() != m_collider_revision)
+	{
+		return false;
+	}
+
+	std::vector<int> cells;
+	if (search.state() == Sliced_search::State::found && !search.extract_path(cells))
+	{
+		return false;
+	}
+
+	path = cells_to_path(cells);
+	return true;
+}
+
+Size A_star::get_tile_size() const
+{
+	return m_tile_size;
+}
+
+std::vector<Position> A_star::create_cooperative_path(Reservation_table & reservations, ecs::Id const& agent, Position const& corner_1, Position const& corner_2, Position const& goal, int window)
+{
+	const Index b_index_1{ get_corresponding_index(corner_1.x, corner_1.y) };
+	const Index b_index_2{ get_corresponding_index(corner_2.x, corner_2.y) };
+	const Index e_index{ get_corresponding_index(goal.x, goal.y) };
+
+	if (!is_inside(b_index_1) || !is_inside(b_index_2) || !is_inside(e_index) || window <= 0)
+	{
+		return {};
+	}
+
+	const int goal_cell{ e_index.y * m_nb_cols + e_index.x };
+
+	// True distances to the goal, ignoring the other agents, as heuristic
+	if (goal_cell != m_cooperative_goal || m_cooperative_revision != m_collider_revision)
+	{
+		m_cooperative_goal = goal_cell;
+		m_cooperative_revision = m_collider_revision;
+		m_flow_bfs.compute(m_colliders, goal_cell, m_cooperative_distances);
+	}
+
+	const int distance_1{ field_distance(m_cooperative_distances, b_index_1.y * m_nb_cols + b_index_1.x) };
+	const int distance_2{ field_distance(m_cooperative_distances, b_index_2.y * m_nb_cols + b_index_2.x) };
+	const Index b_index{ distance_1 > distance_2 ? b_index_1 : b_index_2 };
+	const int start_cell{ b_index.y * m_nb_cols + b_index.x };
+
+	if (std::max(distance_1, distance_2) < 0)
+	{
+		return {};
+	}
+
+	// One node per (tile, step) of the window
+	const int nb_cells{ static_cast<int>(m_colliders.nb_cells()) };
+	const size_t nb_nodes{ static_cast<size_t>(nb_cells) * (window + 1) };
+	if (m_cooperative_search.size() != nb_nodes)
+	{
+		m_cooperative_search.resize(nb_nodes);
+	}
+
+	// Same layout as the search nodes ; only resized when the map or the window changes
+	if (reservations.nb_cells() != m_colliders.nb_cells() || reservations.nb_steps() < window + 1)
+	{
+		reservations.resize(m_colliders.nb_cells(), window + 1);
+	}
+
+	// The agent stays on its goal once there : the tile must be free until the window ends
+	auto can_stay{ [&reservations, &agent, window](int cell, int step)
+	{
+		for (int later{ step + 1 }; later <= window; later++)
 		{
-			Spot neighbor{ m_spot_map[(winner.spot_index.y - 1) * m_nb_cols + winner.spot_index.x] };
-			if (!is_in(close_set, neighbor) && !neighbor.wall)
+			if (!reservations.is_free(cell, later, agent))
 			{
-				int g_temp{ winner.g + 1 };
-				if (is_in(open_set, neighbor))
-				{
-					Spot & neighbor_close = *find(neighbor, open_set); //CARE ABOUT THIS, REMPLACE ALL
-					if (g_temp < neighbor_close.g) { neighbor_close.g = g_temp; };
-
-					neighbor_close.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor_close.f = neighbor.h + neighbor.g;
-					neighbor_close.parent = close_set.size() - 1;
-				}
-				else
-				{
-					neighbor.g = g_temp;
-					neighbor.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor.f = neighbor.h + neighbor.g;
-					neighbor.parent = close_set.size() - 1;
-					open_set.push_back(neighbor);
-				}
-
+				return false;
 			}
 		}
-		if (winner.spot_index.y < m_nb_rows - 1)
+
+		return true;
+	} };
+
+	m_cooperative_search.begin_search();
+	m_cooperative_search.open(start_cell, 0, std::max(distance_1, distance_2), -1);
+
+	int reached{ -1 };
+	while (!m_cooperative_search.empty())
+	{
+		const int winner{ m_cooperative_search.pop() };
+		const int step{ winner / nb_cells };
+		const int cell{ winner % nb_cells };
+
+		if ((cell == goal_cell && can_stay(cell, step)) || step == window)
+		{
+			reached = winner;
+			break;
+		}
+
+		const Index cell_index{ cell % m_nb_cols, cell / m_nb_cols };
+		const int g_temp{ m_cooperative_search.node(winner).g + 1 };
+
+		// Waiting in place is a move too
+		const std::array<Index, 5> moves{ {
+			cell_index,
+			Index{ cell_index.x - 1, cell_index.y },
+			Index{ cell_index.x + 1, cell_index.y },
+			Index{ cell_index.x, cell_index.y - 1 },
+			Index{ cell_index.x, cell_index.y + 1 }
+		} };
+
+		for (auto const& move : moves)
 		{
-			Spot neighbor{ m_spot_map[(winner.spot_index.y + 1) * m_nb_cols + winner.spot_index.x] };
-			if (!is_in(close_set, neighbor) && !neighbor.wall)
+			if (!is_inside(move))
 			{
-				int g_temp{ winner.g + 1 };
-				if (is_in(open_set, neighbor))
-				{
-					Spot & neighbor_close = *find(neighbor, open_set); //CARE ABOUT THIS, REMPLACE ALL
-					if (g_temp < neighbor_close.g) { neighbor_close.g = g_temp; };
-
-					neighbor_close.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor_close.f = neighbor.h + neighbor.g;
-					neighbor_close.parent = close_set.size() - 1;
-				}
-				else
-				{
-					neighbor.g = g_temp;
-					neighbor.h = heuristic(neighbor, m_spot_map[e_index.y * m_nb_cols + e_index.x]);
-					neighbor.f = neighbor.h + neighbor.g;
-					neighbor.parent = close_set.size() - 1;
-					open_set.push_back(neighbor);
-				}
+				continue;
+			}
 
+			const int next_cell{ move.y * m_nb_cols + move.x };
+			if ((next_cell != cell && m_colliders.is_wall(move.x, move.y)) ||
+				!reservations.is_free(next_cell, step + 1, agent) || reservations.crosses(cell, next_cell, step + 1, agent))
+			{
+				continue;
 			}
+
+			const int h{ field_distance(m_cooperative_distances, next_cell) };
+			const int next_node{ (step + 1) * nb_cells + next_cell };
+			if (h < 0 || m_cooperative_search.is_closed(next_node))
+			{
+				continue;
+			}
+
+			m_cooperative_search.open(next_node, g_temp, g_temp + h, winner);
 		}
 	}
+
+	if (reached == -1)
+	{
+		return {};
+	}
+
+	std::vector<Position> path;
+	for (int node{ reached }; node != -1; node = m_cooperative_search.node(node).parent)
+	{
+		reservations.reserve(node % nb_cells, node / nb_cells, agent);
+		path.push_back(cell_center(node % nb_cells));
+	}
+
+	// Reached before the window ends : the last tile stays held
+	for (int step{ reached / nb_cells + 1 }; step <= window; step++)
+	{
+		reservations.reserve(reached % nb_cells, step, agent);
+	}
+
+	return path;
+}
+
+std::vector<Position> A_star::cells_to_path(std::vector<int> const& cells) const
+{
+	std::vector<Position> path;
+	path.reserve(cells.size());
+	for (auto const& cell : cells)
+	{
+		path.push_back( cell_center(cell) );
+	}
+
+	return path;
+}
+
+size_t A_star::write_cells(Path_buffer & buffer, std::vector<int> const& cells) const
+{
+	if (cells.size() > buffer.capacity())
+	{
+		return 0;
+	}
+
+	for (size_t i{ 0 }; i < cells.size(); i++)
+	{
+		buffer.data()[i] = cell_center(cells[i]);
+	}
+
+	return cells.size();
+}
+
+// Drops the changes every bound planner has replayed, and the planners gone
+void A_star::trim_collider_changes()
+{
+	size_t oldest{ m_collider_revision };
+
+	auto it{ m_planner_revisions.begin() };
+	while (it != m_planner_revisions.end())
+	{
+		if (auto revision{ it->lock() })
+		{
+			oldest = std::min(oldest, *revision);
+			++it;
+		}
+		else
+		{
+			it = m_planner_revisions.erase(it);
+		}
+	}
+
+	if (oldest > m_collider_log_base)
+	{
+		m_collider_changes.erase(m_collider_changes.begin(), m_collider_changes.begin() + (oldest - m_collider_log_base));
+		m_collider_log_base = oldest;
+	}
+}
+
+// Keeps every search structure in sync with the new collider
+void A_star::set_collider(Index const& index, bool wall)
+{
+	if (!is_inside(index))
+	{
+		return;
+	}
+
+	if (m_colliders.is_wall(index.x, index.y) == wall)
+	{
+		return;
+	}
+
+	m_colliders.set_wall(index.x, index.y, wall);
+	m_collider_changes.push_back(index);
+	m_collider_revision++;
+	trim_collider_changes();
+
+	const std::vector<bool> wall_map{ m_colliders.to_wall_map() };
+
+	m_jump_search.rebuild(m_nb_cols, m_nb_rows, wall_map);
+	m_hierarchical_path.set_wall(index, wall);
+
+	if (m_distance_table.is_built())
+	{
+		m_distance_table.build(m_nb_cols, m_nb_rows, wall_map);
+	}
+
+	if (m_flow_target != -1)
+	{
+		const int flow_target{ m_flow_target };
+		m_flow_target = -1;
+		update_flow_field(static_cast<float>((flow_target % m_nb_cols) * m_tile_size.width), static_cast<float>((flow_target / m_nb_cols) * m_tile_size.height));
+	}
+
+	if (m_path_service)
+	{
+		m_path_service->set_collider(index, wall);
+	}
+}
+
+void A_star::set_path_service(Path_service * path_service)
+{
+	m_path_service = path_service;
+}
+
+// Reuses the cached table if it matches the collider map, otherwise builds and caches it
+bool A_star::enable_distance_table(std::string const& cache_path)
+{
+	// The flow field already answers the paths toward its target
+	if (m_flow_enabled)
+	{
+		return false;
+	}
+
+	const std::vector<bool> wall_map{ m_colliders.to_wall_map() };
+	m_table_cells.reserve(max_path_length());
+
+	if (!cache_path.empty() && m_distance_table.load(cache_path, m_nb_cols, m_nb_rows, wall_map))
+	{
+		return true;
+	}
+
+	if (!m_distance_table.build(m_nb_cols, m_nb_rows, wall_map))
+	{
+		std::cout << "Map too large for a distance table (A*)" << std::endl;
+		return false;
+	}
+
+	if (!cache_path.empty())
+	{
+		m_distance_table.save(cache_path);
+	}
+
+	return true;
+}
+
+void A_star::disable_distance_table()
+{
+	m_distance_table.clear();
+}
+
+void A_star::set_flow_field_enabled(bool enabled)
+{
+	m_flow_enabled = enabled;
+	m_flow_target = -1;
+
+	if (enabled)
+	{
+		m_distance_table.clear();
+	}
+}
+
+bool A_star::flow_field_enabled() const
+{
+	return m_flow_enabled;
+}
+
+// BFS from the target tile, redone only when the target changes tile
+void A_star::update_flow_field(float x, float y)
+{
+	const Index target{ get_corresponding_index(x, y) };
+
+	if (!m_flow_enabled || !is_inside(target))
+	{
+		m_flow_target = -1;
+		return;
+	}
+
+	const int target_cell{ target.y * m_nb_cols + target.x };
+	if (target_cell == m_flow_target)
+	{
+		return;
+	}
+
+	m_flow_target = target_cell;
+	m_flow_bfs.compute(m_colliders, target_cell, m_flow_distances);
+}
+
+bool A_star::flow_field_targets(float x, float y) const
+{
+	const Index target{ get_corresponding_index(x, y) };
+
+	return m_flow_target != -1 && is_inside(target) && target.y * m_nb_cols + target.x == m_flow_target;
+}
+
+// Steps left to the flow target, -1 when unreachable or without field
+int A_star::flow_distance(float x, float y) const
+{
+	const Index index{ get_corresponding_index(x, y) };
+
+	if (m_flow_target == -1 || !is_inside(index))
+	{
+		return -1;
+	}
+
+	return flow_cell_distance(index.y * m_nb_cols + index.x);
+}
+
+int A_star::flow_cell_distance(int cell) const
+{
+	return field_distance(m_flow_distances, cell);
+}
+
+// A wall cell (agent corner overlapping a wall) takes its distance from its best neighbor, as A* would
+int A_star::field_distance(std::vector<int> const& distances, int cell) const
+{
+	if (!m_colliders.is_wall(cell))
+	{
+		return distances[cell];
+	}
+
+	const int x_cell{ cell % m_nb_cols };
+	const int y_cell{ cell / m_nb_cols };
+
+	const std::array<Index, 4> neighbors{ {
+		Index{ x_cell - 1, y_cell },
+		Index{ x_cell + 1, y_cell },
+		Index{ x_cell, y_cell - 1 },
+		Index{ x_cell, y_cell + 1 }
+	} };
+
+	int result{ -1 };
+	for (auto const& neighbor : neighbors)
+	{
+		if (!is_inside(neighbor))
+		{
+			continue;
+		}
+
+		const int distance{ distances[neighbor.y * m_nb_cols + neighbor.x] };
+		if (distance != -1 && (result == -1 || distance + 1 < result))
+		{
+			result = distance + 1;
+		}
+	}
+
+	return result;
+}
+
+int A_star::flow_next_cell(int cell) const
+{
+	const int distance{ flow_cell_distance(cell) };
+	const int x_cell{ cell % m_nb_cols };
+	const int y_cell{ cell / m_nb_cols };
+
+	const std::array<Index, 4> neighbors{ {
+		Index{ x_cell - 1, y_cell },
+		Index{ x_cell + 1, y_cell },
+		Index{ x_cell, y_cell - 1 },
+		Index{ x_cell, y_cell + 1 }
+	} };
+
+	for (auto const& neighbor : neighbors)
+	{
+		if (is_inside(neighbor) && m_flow_distances[neighbor.y * m_nb_cols + neighbor.x] == distance - 1)
+		{
+			return neighbor.y * m_nb_cols + neighbor.x;
+		}
+	}
+
+	return -1;
+}
+
+// Center of the next tile toward the flow target, false if there or unreachable
+bool A_star::flow_next_position(float x, float y, Position & next) const
+{
+	if (flow_distance(x, y) <= 0)
+	{
+		return false;
+	}
+
+	const Index index{ get_corresponding_index(x, y) };
+	next = cell_center(flow_next_cell(index.y * m_nb_cols + index.x));
+
+	return true;
+}
+
+// Same layout as extract_path : flow target first, start last
+std::vector<Position> A_star::extract_flow_path(int start_cell) const
+{
+	const int distance{ flow_cell_distance(start_cell) };
+	if (distance == -1)
+	{
+		return {};
+	}
+
+	std::vector<Position> path(distance + 1);
+
+	for (int cell{ start_cell }, i{ static_cast<int>(path.size()) - 1 }; i >= 0; cell = flow_next_cell(cell), i--)
+	{
+		path[i] = cell_center(cell);
+	}
+
+	return path;
+}
+
+size_t A_star::write_flow_path(Path_buffer & buffer, int start_cell) const
+{
+	const int distance{ flow_cell_distance(start_cell) };
+	if (distance == -1 || static_cast<size_t>(distance) + 1 > buffer.capacity())
+	{
+		return 0;
+	}
+
+	Position * positions{ buffer.data() };
+	for (int cell{ start_cell }, i{ distance }; i >= 0; cell = flow_next_cell(cell), i--)
+	{
+		positions[i] = cell_center(cell);
+	}
+
+	return static_cast<size_t>(distance) + 1;
 }
 
 A_star::~A_star()
 {
+	{
+		std::lock_guard<std::mutex> lock{ m_batch_mutex };
+		m_batch_stopping = true;
+	}
+	m_batch_wake.notify_all();
+
+	for (auto & thread : m_batch_threads)
+	{
+		thread.join();
+	}
 }
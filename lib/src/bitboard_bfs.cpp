@@ -0,0 +1,183 @@
+#include "bitboard_bfs.h"
+
+#include <algorithm>
+
+namespace
+{
+	int lowest_bit(std::uint64_t word)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctzll(word);
+#else
+		int bit{ 0 };
+		while (!(word & 1)) { word >>= 1; bit++; }
+		return bit;
+#endif
+	}
+
+	// One frontier step on the words [first, last) of a row ; returns true when a tile was reached
+	bool expand_words(std::uint64_t const* frontier, std::uint64_t const* open, std::uint64_t * visited, std::uint64_t * next, int stride, int first, int last)
+	{
+		std::uint64_t reached{ 0 };
+
+		for (int word{ first }; word < last; word++)
+		{
+			// Nothing left to reach here ; next is already zero
+			const std::uint64_t reachable{ open[word] & ~visited[word] };
+			if (reachable == 0)
+			{
+				continue;
+			}
+
+			const std::uint64_t center{ frontier[word] };
+			const std::uint64_t grown{ center | (center << 1) | (frontier[word - 1] >> 63) | (center >> 1) | (frontier[word + 1] << 63) |
+				frontier[word - stride] | frontier[word + stride] };
+
+			const std::uint64_t fresh{ grown & reachable };
+			next[word] = fresh;
+			visited[word] |= fresh;
+			reached |= fresh;
+		}
+
+		return reached != 0;
+	}
+}
+
+Bitboard_bfs::Bitboard_bfs()
+{
+}
+
+void Bitboard_bfs::prepare(Collider_grid const& colliders)
+{
+	const int words_per_row{ colliders.words_per_row() };
+	const int nb_rows{ colliders.nb_rows() };
+
+	m_stride = words_per_row + 2;
+	const size_t size{ static_cast<size_t>(m_stride) * (nb_rows + 2) };
+
+	m_open.assign(size, 0);
+	m_visited.assign(size, 0);
+	m_frontier.assign(size, 0);
+	m_next.assign(size, 0);
+
+	m_first_words.assign(nb_rows, words_per_row);
+	m_last_words.assign(nb_rows, -1);
+	m_next_first_words.assign(nb_rows, words_per_row);
+	m_next_last_words.assign(nb_rows, -1);
+
+	// Padding bits of the grid are walls, so the border words and bits stay closed
+	for (int y{ 0 }; y < nb_rows; y++)
+	{
+		std::uint64_t * row{ &m_open[static_cast<size_t>(y + 1) * m_stride + 1] };
+		for (int word{ 0 }; word < words_per_row; word++)
+		{
+			row[word] = ~colliders.row_word(y, word);
+		}
+	}
+}
+
+void Bitboard_bfs::compute(Collider_grid const& colliders, int target_cell, std::vector<int> & distances)
+{
+	const int nb_cols{ colliders.nb_cols() };
+	const int nb_rows{ colliders.nb_rows() };
+	const int words_per_row{ colliders.words_per_row() };
+
+	distances.assign(colliders.nb_cells(), -1);
+	if (target_cell < 0 || static_cast<size_t>(target_cell) >= colliders.nb_cells())
+	{
+		return;
+	}
+
+	prepare(colliders);
+
+	const int target_x{ target_cell % nb_cols };
+	const int target_y{ target_cell / nb_cols };
+	const size_t target_word{ static_cast<size_t>(target_y + 1) * m_stride + 1 + target_x / 64 };
+	const std::uint64_t target_bit{ std::uint64_t{ 1 } << (target_x % 64) };
+
+	m_frontier[target_word] = target_bit;
+	m_visited[target_word] = target_bit;
+	m_first_words[target_y] = target_x / 64;
+	m_last_words[target_y] = target_x / 64;
+	distances[target_cell] = 0;
+
+	int first_row{ target_y };
+	int last_row{ target_y };
+
+	for (int distance{ 1 }; first_row <= last_row; distance++)
+	{
+		const int from{ std::max(0, first_row - 1) };
+		const int to{ std::min(nb_rows - 1, last_row + 1) };
+
+		int next_first{ nb_rows };
+		int next_last{ -1 };
+
+		for (int y{ from }; y <= to; y++)
+		{
+			// Only the words next to a frontier word of this row or the rows around it
+			int first_word{ words_per_row };
+			int last_word{ -1 };
+			for (int around{ std::max(first_row, y - 1) }; around <= std::min(last_row, y + 1); around++)
+			{
+				first_word = std::min(first_word, m_first_words[around]);
+				last_word = std::max(last_word, m_last_words[around]);
+			}
+
+			if (first_word > last_word)
+			{
+				continue;
+			}
+
+			first_word = std::max(0, first_word - 1);
+			last_word = std::min(words_per_row - 1, last_word + 1);
+
+			const size_t row{ static_cast<size_t>(y + 1) * m_stride + 1 };
+			if (!expand_words(&m_frontier[row], &m_open[row], &m_visited[row], &m_next[row], m_stride, first_word, last_word + 1))
+			{
+				continue;
+			}
+
+			next_first = std::min(next_first, y);
+			next_last = std::max(next_last, y);
+
+			for (int word{ first_word }; word <= last_word; word++)
+			{
+				std::uint64_t fresh{ m_next[row + word] };
+				if (fresh == 0)
+				{
+					continue;
+				}
+
+				m_next_first_words[y] = std::min(m_next_first_words[y], word);
+				m_next_last_words[y] = word;
+
+				for (; fresh != 0; fresh &= fresh - 1)
+				{
+					distances[static_cast<size_t>(y) * nb_cols + word * 64 + lowest_bit(fresh)] = distance;
+				}
+			}
+		}
+
+		// The old frontier is cleared so its buffers come back empty as next
+		for (int y{ first_row }; y <= last_row; y++)
+		{
+			if (m_first_words[y] <= m_last_words[y])
+			{
+				std::fill(&m_frontier[static_cast<size_t>(y + 1) * m_stride + 1 + m_first_words[y]],
+					&m_frontier[static_cast<size_t>(y + 1) * m_stride + 1 + m_last_words[y] + 1], 0);
+			}
+			m_first_words[y] = words_per_row;
+			m_last_words[y] = -1;
+		}
+		std::swap(m_frontier, m_next);
+		std::swap(m_first_words, m_next_first_words);
+		std::swap(m_last_words, m_next_last_words);
+
+		first_row = next_first;
+		last_row = next_last;
+	}
+}
+
+Bitboard_bfs::~Bitboard_bfs()
+{
+}
@@ -0,0 +1,252 @@
+#include "box_batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BOX_BATCH_SIMD
+#define BOX_BATCH_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+// MSVC compiles the intrinsics without /arch, the checks below keep them off older cpus
+#include <intrin.h>
+#include <immintrin.h>
+#define BOX_BATCH_SIMD
+#define BOX_BATCH_TARGET(isa)
+#endif
+
+namespace
+{
+	struct Box_bounds
+	{
+		float x1;
+		float x2;
+		float y1;
+		float y2;
+	};
+
+	int lowest_bit(unsigned int mask)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+		unsigned long bit;
+		_BitScanForward(&bit, mask);
+		return static_cast<int>(bit);
+#else
+		int bit{ 0 };
+		while (!(mask & 1)) { mask >>= 1; bit++; }
+		return bit;
+#endif
+	}
+
+	// Writes the index of every overlapping box from first to count, returns the end of hits
+	size_t* overlap_range(float const* x, float const* y, float const* w, float const* h, size_t first, size_t count, Box_bounds const& box, size_t * hits)
+	{
+		for (size_t i{ first }; i < count; i++)
+		{
+			if (box.x1 < x[i] + w[i] && box.x2 > x[i] && box.y1 < y[i] + h[i] && box.y2 > y[i])
+			{
+				*hits++ = i;
+			}
+		}
+
+		return hits;
+	}
+
+	size_t* add_lanes(unsigned int mask, size_t first, size_t * hits)
+	{
+		while (mask != 0)
+		{
+			*hits++ = first + lowest_bit(mask);
+			mask &= mask - 1;
+		}
+
+		return hits;
+	}
+
+	using Overlap = size_t*(*)(float const*, float const*, float const*, float const*, size_t, Box_bounds const&, size_t *);
+
+	size_t* overlap_scalar(float const* x, float const* y, float const* w, float const* h, size_t count, Box_bounds const& box, size_t * hits)
+	{
+		return overlap_range(x, y, w, h, 0, count, box, hits);
+	}
+
+#if defined(BOX_BATCH_SIMD)
+	BOX_BATCH_TARGET("sse")
+	size_t* overlap_sse(float const* x, float const* y, float const* w, float const* h, size_t count, Box_bounds const& box, size_t * hits)
+	{
+		const __m128 x1{ _mm_set1_ps(box.x1) };
+		const __m128 x2{ _mm_set1_ps(box.x2) };
+		const __m128 y1{ _mm_set1_ps(box.y1) };
+		const __m128 y2{ _mm_set1_ps(box.y2) };
+
+		size_t i{ 0 };
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 left{ _mm_loadu_ps(x + i) };
+			const __m128 top{ _mm_loadu_ps(y + i) };
+
+			__m128 hit{ _mm_cmplt_ps(x1, _mm_add_ps(left, _mm_loadu_ps(w + i))) };
+			hit = _mm_and_ps(hit, _mm_cmpgt_ps(x2, left));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(y1, _mm_add_ps(top, _mm_loadu_ps(h + i))));
+			hit = _mm_and_ps(hit, _mm_cmpgt_ps(y2, top));
+
+			hits = add_lanes(static_cast<unsigned int>(_mm_movemask_ps(hit)), i, hits);
+		}
+
+		return overlap_range(x, y, w, h, i, count, box, hits);
+	}
+
+	BOX_BATCH_TARGET("avx2")
+	size_t* overlap_avx2(float const* x, float const* y, float const* w, float const* h, size_t count, Box_bounds const& box, size_t * hits)
+	{
+		const __m256 x1{ _mm256_set1_ps(box.x1) };
+		const __m256 x2{ _mm256_set1_ps(box.x2) };
+		const __m256 y1{ _mm256_set1_ps(box.y1) };
+		const __m256 y2{ _mm256_set1_ps(box.y2) };
+
+		size_t i{ 0 };
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 left{ _mm256_loadu_ps(x + i) };
+			const __m256 top{ _mm256_loadu_ps(y + i) };
+
+			__m256 hit{ _mm256_cmp_ps(x1, _mm256_add_ps(left, _mm256_loadu_ps(w + i)), _CMP_LT_OQ) };
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(x2, left, _CMP_GT_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(y1, _mm256_add_ps(top, _mm256_loadu_ps(h + i)), _CMP_LT_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(y2, top, _CMP_GT_OQ));
+
+			hits = add_lanes(static_cast<unsigned int>(_mm256_movemask_ps(hit)), i, hits);
+		}
+
+		return overlap_range(x, y, w, h, i, count, box, hits);
+	}
+
+	bool cpu_has_avx2()
+	{
+#if defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+#else
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// AVX and OSXSAVE, then the system saving the ymm registers
+		__cpuid(info, 1);
+		const int avx_bits{ (1 << 27) | (1 << 28) };
+		if ((info[2] & avx_bits) != avx_bits || (_xgetbv(0) & 6) != 6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#endif
+	}
+
+	bool cpu_has_sse()
+	{
+#if defined(__GNUC__)
+		return __builtin_cpu_supports("sse");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 25)) != 0;
+#endif
+	}
+#endif
+
+	Overlap pick_overlap()
+	{
+#if defined(BOX_BATCH_SIMD)
+#if defined(__GNUC__)
+		__builtin_cpu_init();
+#endif
+		if (cpu_has_avx2())
+		{
+			return overlap_avx2;
+		}
+		if (cpu_has_sse())
+		{
+			return overlap_sse;
+		}
+#endif
+		return overlap_scalar;
+	}
+
+	// Picked on the first test rather than during static initialization
+	Overlap get_overlap()
+	{
+		static const Overlap overlap{ pick_overlap() };
+
+		return overlap;
+	}
+}
+
+Box_batch::Box_batch()
+{
+}
+
+void Box_batch::push_back(Position const& pos, Size const& size)
+{
+	m_x.push_back(pos.x);
+	m_y.push_back(pos.y);
+	m_w.push_back(static_cast<float>(size.width));
+	m_h.push_back(static_cast<float>(size.height));
+}
+
+void Box_batch::clear()
+{
+	m_x.clear();
+	m_y.clear();
+	m_w.clear();
+	m_h.clear();
+}
+
+void Box_batch::reserve(size_t capacity)
+{
+	m_x.reserve(capacity);
+	m_y.reserve(capacity);
+	m_w.reserve(capacity);
+	m_h.reserve(capacity);
+}
+
+size_t Box_batch::size() const
+{
+	return m_x.size();
+}
+
+void Box_batch::overlapping(Position const& pos, Size const& size, std::vector<size_t> & hits) const
+{
+	// Room for every box, trimmed to the hits afterwards
+	const size_t first{ hits.size() };
+	hits.resize(first + m_x.size());
+
+	const Box_bounds box{ pos.x, pos.x + size.width, pos.y, size.height + pos.y };
+	size_t const* end{ get_overlap()(m_x.data(), m_y.data(), m_w.data(), m_h.data(), m_x.size(), box, hits.data() + first) };
+
+	hits.resize(static_cast<size_t>(end - hits.data()));
+}
+
+bool Box_batch::uses_avx2()
+{
+#if defined(BOX_BATCH_SIMD)
+	return get_overlap() == overlap_avx2;
+#else
+	return false;
+#endif
+}
+
+bool Box_batch::uses_sse()
+{
+#if defined(BOX_BATCH_SIMD)
+	return get_overlap() == overlap_sse;
+#else
+	return false;
+#endif
+}
+
+Box_batch::~Box_batch()
+{
+}
@@ -0,0 +1,247 @@
+#include "collider_grid.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	int lowest_bit(std::uint64_t word)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	int highest_bit(std::uint64_t word)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, word);
+		return static_cast<int>(index);
+#else
+		return 63 - __builtin_clzll(word);
+#endif
+	}
+
+	const std::uint64_t all_walls{ ~std::uint64_t{ 0 } };
+}
+
+Collider_grid::Collider_grid()
+{
+}
+
+Collider_grid::Collider_grid(int nb_cols, int nb_rows, std::vector<bool> const& wall_map) :
+	m_nb_cols{ nb_cols },
+	m_nb_rows{ nb_rows },
+	m_words_per_row{ (nb_cols + word_bits - 1) / word_bits },
+	m_words(static_cast<size_t>(m_words_per_row) * nb_rows, 0)
+{
+	for (int y{ 0 }; y < nb_rows; y++)
+	{
+		std::uint64_t * row{ &m_words[static_cast<size_t>(y) * m_words_per_row] };
+
+		for (int x{ 0 }; x < nb_cols; x++)
+		{
+			if (wall_map[static_cast<size_t>(y) * nb_cols + x])
+			{
+				row[x / word_bits] |= std::uint64_t{ 1 } << (x % word_bits);
+			}
+		}
+
+		if (nb_cols % word_bits != 0)
+		{
+			row[m_words_per_row - 1] |= bit_range(nb_cols % word_bits, word_bits - 1);
+		}
+	}
+}
+
+int Collider_grid::nb_cols() const
+{
+	return m_nb_cols;
+}
+
+int Collider_grid::nb_rows() const
+{
+	return m_nb_rows;
+}
+
+size_t Collider_grid::nb_cells() const
+{
+	return static_cast<size_t>(m_nb_cols) * m_nb_rows;
+}
+
+int Collider_grid::words_per_row() const
+{
+	return m_words_per_row;
+}
+
+bool Collider_grid::is_wall(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= m_nb_cols || y >= m_nb_rows)
+	{
+		return true;
+	}
+
+	return (m_words[static_cast<size_t>(y) * m_words_per_row + x / word_bits] >> (x % word_bits)) & 1;
+}
+
+bool Collider_grid::is_wall(int cell) const
+{
+	return is_wall(cell % m_nb_cols, cell / m_nb_cols);
+}
+
+void Collider_grid::set_wall(int x, int y, bool wall)
+{
+	if (x < 0 || y < 0 || x >= m_nb_cols || y >= m_nb_rows)
+	{
+		return;
+	}
+
+	std::uint64_t & word{ m_words[static_cast<size_t>(y) * m_words_per_row + x / word_bits] };
+	const std::uint64_t bit{ std::uint64_t{ 1 } << (x % word_bits) };
+
+	word = wall ? (word | bit) : (word & ~bit);
+}
+
+std::uint64_t Collider_grid::bit_range(int first, int last)
+{
+	const std::uint64_t up_to_last{ last >= word_bits - 1 ? all_walls : (std::uint64_t{ 1 } << (last + 1)) - 1 };
+	return up_to_last & (all_walls << first);
+}
+
+bool Collider_grid::any_wall(int x_1, int y_1, int x_2, int y_2) const
+{
+	if (x_1 > x_2) { std::swap(x_1, x_2); }
+	if (y_1 > y_2) { std::swap(y_1, y_2); }
+
+	if (x_1 < 0 || y_1 < 0 || x_2 >= m_nb_cols || y_2 >= m_nb_rows)
+	{
+		return true;
+	}
+
+	const int first_word{ x_1 / word_bits };
+	const int last_word{ x_2 / word_bits };
+
+	for (int y{ y_1 }; y <= y_2; y++)
+	{
+		std::uint64_t const* row{ &m_words[static_cast<size_t>(y) * m_words_per_row] };
+
+		for (int word{ first_word }; word <= last_word; word++)
+		{
+			const int first{ word == first_word ? x_1 % word_bits : 0 };
+			const int last{ word == last_word ? x_2 % word_bits : word_bits - 1 };
+
+			if (row[word] & bit_range(first, last))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+int Collider_grid::first_wall(int y, int x_from, int x_to) const
+{
+	if (y < 0 || y >= m_nb_rows)
+	{
+		return -1;
+	}
+
+	x_from = std::max(0, std::min(x_from, m_nb_cols - 1));
+	x_to = std::max(0, std::min(x_to, m_nb_cols - 1));
+
+	std::uint64_t const* row{ &m_words[static_cast<size_t>(y) * m_words_per_row] };
+
+	if (x_from <= x_to)
+	{
+		for (int word{ x_from / word_bits }; word <= x_to / word_bits; word++)
+		{
+			const int first{ word == x_from / word_bits ? x_from % word_bits : 0 };
+			const int last{ word == x_to / word_bits ? x_to % word_bits : word_bits - 1 };
+
+			const std::uint64_t walls{ row[word] & bit_range(first, last) };
+			if (walls)
+			{
+				return word * word_bits + lowest_bit(walls);
+			}
+		}
+	}
+	else
+	{
+		for (int word{ x_from / word_bits }; word >= x_to / word_bits; word--)
+		{
+			const int first{ word == x_to / word_bits ? x_to % word_bits : 0 };
+			const int last{ word == x_from / word_bits ? x_from % word_bits : word_bits - 1 };
+
+			const std::uint64_t walls{ row[word] & bit_range(first, last) };
+			if (walls)
+			{
+				return word * word_bits + highest_bit(walls);
+			}
+		}
+	}
+
+	return -1;
+}
+
+std::uint64_t Collider_grid::row_word(int y, int word) const
+{
+	if (y < 0 || y >= m_nb_rows || word < 0 || word >= m_words_per_row)
+	{
+		return all_walls;
+	}
+
+	return m_words[static_cast<size_t>(y) * m_words_per_row + word];
+}
+
+std::uint64_t Collider_grid::open_neighbors(int y, int word, int dx, int dy) const
+{
+	const int row{ y + dy };
+	std::uint64_t walls{ row_word(row, word) };
+
+	// The neighbor of the first / last bit sits in the next word
+	if (dx > 0)
+	{
+		walls = (walls >> 1) | (row_word(row, word + 1) << (word_bits - 1));
+	}
+	else if (dx < 0)
+	{
+		walls = (walls << 1) | (row_word(row, word - 1) >> (word_bits - 1));
+	}
+
+	// Only the tiles of the row have neighbors
+	if (y < 0 || y >= m_nb_rows || word < 0 || word >= m_words_per_row)
+	{
+		return 0;
+	}
+
+	const int last{ word == m_words_per_row - 1 ? (m_nb_cols - 1) % word_bits : word_bits - 1 };
+	return ~walls & bit_range(0, last);
+}
+
+std::vector<bool> Collider_grid::to_wall_map() const
+{
+	std::vector<bool> wall_map(nb_cells());
+
+	for (int y{ 0 }; y < m_nb_rows; y++)
+	{
+		for (int x{ 0 }; x < m_nb_cols; x++)
+		{
+			wall_map[static_cast<size_t>(y) * m_nb_cols + x] = is_wall(x, y);
+		}
+	}
+
+	return wall_map;
+}
+
+Collider_grid::~Collider_grid()
+{
+}
@@ -0,0 +1,30 @@
+#include "corner_path.h"
+
+bool next_step(std::vector<Position> const& path, Position & next_position)
+{
+	if (path.size() < 2)
+	{
+		return false;
+	}
+
+	next_position = path[path.size() - 2];
+	return true;
+}
+
+bool choose_buffered_step(A_star & path_finding, Path_buffer (&corners)[2], Position const& pos_target, Size const& size_target, Position const& final_pos, Position & next_position)
+{
+	size_t lengths[2]{ 0, 0 };
+	const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+	{
+		lengths[i] = path_finding.write_center_path(corners[i], pos.x, pos.y, final_pos.x, final_pos.y);
+		return lengths[i];
+	}) };
+
+	if (lengths[corner] < 2)
+	{
+		return false;
+	}
+
+	next_position = corners[corner][lengths[corner] - 2];
+	return true;
+}
@@ -0,0 +1,285 @@
+#include "distance_table.h"
+
+#include <fstream>
+#include <thread>
+#include <algorithm>
+
+const std::uint32_t table_file_magic{ 0x31425444 }; // "DTB1"
+
+Distance_table::Distance_table()
+{
+}
+
+int Distance_table::neighbor_cell(int cell, int direction) const
+{
+	const int x{ cell % m_nb_cols };
+	const int y{ cell / m_nb_cols };
+
+	switch (direction)
+	{
+	case 0: return x > 0 ? cell - 1 : -1;
+	case 1: return x < m_nb_cols - 1 ? cell + 1 : -1;
+	case 2: return y > 0 ? cell - m_nb_cols : -1;
+	case 3: return y < m_nb_rows - 1 ? cell + m_nb_cols : -1;
+	default: return -1;
+	}
+}
+
+std::uint64_t Distance_table::map_hash(std::vector<bool> const& wall_map) const
+{
+	std::uint64_t hash{ 14695981039346656037ull };
+	auto mix{ [&hash](std::uint64_t value) { hash = (hash ^ value) * 1099511628211ull; } };
+
+	mix(static_cast<std::uint64_t>(m_nb_cols));
+	mix(static_cast<std::uint64_t>(m_nb_rows));
+	for (bool wall : wall_map)
+	{
+		mix(wall ? 1 : 0);
+	}
+
+	return hash;
+}
+
+void Distance_table::index_walkable(int nb_cols, int nb_rows, std::vector<bool> const& wall_map)
+{
+	m_nb_cols = nb_cols;
+	m_nb_rows = nb_rows;
+	m_hash = map_hash(wall_map);
+
+	m_cell_to_slot.assign(wall_map.size(), -1);
+	m_slot_to_cell.clear();
+
+	for (size_t cell{ 0 }; cell < wall_map.size(); cell++)
+	{
+		if (!wall_map[cell])
+		{
+			m_cell_to_slot[cell] = static_cast<int>(m_slot_to_cell.size());
+			m_slot_to_cell.push_back(static_cast<int>(cell));
+		}
+	}
+
+	m_nb_walkable = static_cast<int>(m_slot_to_cell.size());
+}
+
+// One BFS per goal : the BFS parent of a tile is its next hop toward that goal
+void Distance_table::fill_from_goals(int first_goal, int last_goal)
+{
+	std::vector<int> queue;
+	queue.reserve(m_nb_walkable);
+
+	for (int goal{ first_goal }; goal < last_goal; goal++)
+	{
+		std::uint8_t * next_hops{ &m_next_hops[static_cast<size_t>(goal) * m_nb_walkable] };
+		std::uint16_t * distances{ &m_distances[static_cast<size_t>(goal) * m_nb_walkable] };
+
+		queue.clear();
+		queue.push_back(goal);
+		distances[goal] = 0;
+
+		for (size_t head{ 0 }; head < queue.size(); head++)
+		{
+			const int slot{ queue[head] };
+
+			for (int direction{ 0 }; direction < 4; direction++)
+			{
+				const int neighbor{ neighbor_cell(m_slot_to_cell[slot], direction) };
+				const int neighbor_slot{ neighbor == -1 ? -1 : m_cell_to_slot[neighbor] };
+
+				if (neighbor_slot != -1 && next_hops[neighbor_slot] == no_hop && neighbor_slot != goal)
+				{
+					// Going back from the neighbor is the opposite direction
+					next_hops[neighbor_slot] = static_cast<std::uint8_t>(direction ^ 1);
+					distances[neighbor_slot] = static_cast<std::uint16_t>(distances[slot] + 1);
+					queue.push_back(neighbor_slot);
+				}
+			}
+		}
+	}
+}
+
+bool Distance_table::build(int nb_cols, int nb_rows, std::vector<bool> const& wall_map)
+{
+	index_walkable(nb_cols, nb_rows, wall_map);
+
+	if (m_nb_walkable > max_walkable_tiles)
+	{
+		clear();
+		return false;
+	}
+
+	const size_t nb_entries{ static_cast<size_t>(m_nb_walkable) * m_nb_walkable };
+	m_next_hops.assign(nb_entries, no_hop);
+	m_distances.assign(nb_entries, 0);
+
+	const int nb_threads{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+	const int goals_per_thread{ (m_nb_walkable + nb_threads - 1) / nb_threads };
+
+	std::vector<std::thread> workers;
+	for (int first{ goals_per_thread }; first < m_nb_walkable; first += goals_per_thread)
+	{
+		workers.emplace_back(&Distance_table::fill_from_goals, this, first, std::min(first + goals_per_thread, m_nb_walkable));
+	}
+
+	fill_from_goals(0, std::min(goals_per_thread, m_nb_walkable));
+
+	for (auto & worker : workers)
+	{
+		worker.join();
+	}
+
+	return true;
+}
+
+bool Distance_table::save(std::string const& file_path) const
+{
+	if (!is_built())
+	{
+		return false;
+	}
+
+	std::ofstream file{ file_path, std::ios::binary };
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::int32_t header[3]{ m_nb_cols, m_nb_rows, m_nb_walkable };
+
+	file.write(reinterpret_cast<const char*>(&table_file_magic), sizeof(table_file_magic));
+	file.write(reinterpret_cast<const char*>(&m_hash), sizeof(m_hash));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(m_next_hops.data()), m_next_hops.size() * sizeof(std::uint8_t));
+	file.write(reinterpret_cast<const char*>(m_distances.data()), m_distances.size() * sizeof(std::uint16_t));
+
+	return static_cast<bool>(file);
+}
+
+bool Distance_table::load(std::string const& file_path, int nb_cols, int nb_rows, std::vector<bool> const& wall_map)
+{
+	std::ifstream file{ file_path, std::ios::binary };
+	if (!file)
+	{
+		return false;
+	}
+
+	std::uint32_t magic{ 0 };
+	std::uint64_t hash{ 0 };
+	std::int32_t header[3]{ 0, 0, 0 };
+
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	index_walkable(nb_cols, nb_rows, wall_map);
+
+	if (!file || magic != table_file_magic || hash != m_hash ||
+		header[0] != nb_cols || header[1] != nb_rows || header[2] != m_nb_walkable)
+	{
+		clear();
+		return false;
+	}
+
+	const size_t nb_entries{ static_cast<size_t>(m_nb_walkable) * m_nb_walkable };
+	m_next_hops.resize(nb_entries);
+	m_distances.resize(nb_entries);
+
+	file.read(reinterpret_cast<char*>(m_next_hops.data()), nb_entries * sizeof(std::uint8_t));
+	file.read(reinterpret_cast<char*>(m_distances.data()), nb_entries * sizeof(std::uint16_t));
+
+	if (!file)
+	{
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+void Distance_table::clear()
+{
+	m_nb_walkable = 0;
+	m_cell_to_slot.clear();
+	m_slot_to_cell.clear();
+	m_next_hops.clear();
+	m_distances.clear();
+}
+
+bool Distance_table::is_built() const
+{
+	return !m_next_hops.empty();
+}
+
+int Distance_table::distance(int start_cell, int goal_cell) const
+{
+	const int start{ m_cell_to_slot[start_cell] };
+	const int goal{ m_cell_to_slot[goal_cell] };
+
+	if (start == -1 || goal == -1)
+	{
+		return -1;
+	}
+
+	const size_t entry{ static_cast<size_t>(goal) * m_nb_walkable + start };
+	if (start != goal && m_next_hops[entry] == no_hop)
+	{
+		return -1;
+	}
+
+	return m_distances[entry];
+}
+
+bool Distance_table::find_path(int start_cell, int goal_cell, std::vector<int> & cells) const
+{
+	if (start_cell == goal_cell)
+	{
+		cells.push_back(start_cell);
+		return true;
+	}
+
+	// A start on a wall (agent corner) goes through its best walkable neighbor, as A* would
+	int from_cell{ start_cell };
+	if (m_cell_to_slot[start_cell] == -1)
+	{
+		int best{ -1 };
+		for (int direction{ 0 }; direction < 4; direction++)
+		{
+			const int neighbor{ neighbor_cell(start_cell, direction) };
+			const int neighbor_distance{ neighbor == -1 ? -1 : distance(neighbor, goal_cell) };
+
+			if (neighbor_distance != -1 && (best == -1 || neighbor_distance < distance(best, goal_cell)))
+			{
+				best = neighbor;
+			}
+		}
+
+		from_cell = best;
+	}
+
+	if (from_cell == -1 || distance(from_cell, goal_cell) == -1)
+	{
+		return false;
+	}
+
+	const size_t first{ cells.size() };
+	const int goal{ m_cell_to_slot[goal_cell] };
+	const size_t row{ static_cast<size_t>(goal) * m_nb_walkable };
+
+	if (from_cell != start_cell)
+	{
+		cells.push_back(start_cell);
+	}
+
+	for (int cell{ from_cell }; cell != goal_cell; cell = neighbor_cell(cell, m_next_hops[row + m_cell_to_slot[cell]]))
+	{
+		cells.push_back(cell);
+	}
+	cells.push_back(goal_cell);
+
+	std::reverse(cells.begin() + first, cells.end());
+
+	return true;
+}
+
+Distance_table::~Distance_table()
+{
+}
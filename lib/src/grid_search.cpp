@@ -0,0 +1,75 @@
+#include "grid_search.h"
+
+#include <cmath>
+#include <array>
+#include <limits>
+
+int grid_distance(Index const& a, Index const& b)
+{
+	return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+}
+
+void start_grid_search(Search_space & search, Collider_grid const& colliders, Index const& start, Index const& goal)
+{
+	if (search.size() != colliders.nb_cells())
+	{
+		search.resize(colliders.nb_cells());
+	}
+
+	search.begin_search();
+	search.open(start.y * colliders.nb_cols() + start.x, 0, grid_distance(start, goal), -1);
+}
+
+Grid_search_state expand_grid_search(Search_space & search, Collider_grid const& colliders, Index const& goal, int & budget)
+{
+	const int nb_cols{ colliders.nb_cols() };
+	const int goal_cell{ goal.y * nb_cols + goal.x };
+
+	while (budget > 0)
+	{
+		if (search.empty())
+		{
+			return Grid_search_state::failed;
+		}
+
+		const int winner{ search.pop() };
+		budget--;
+
+		if (winner == goal_cell)
+		{
+			return Grid_search_state::found;
+		}
+
+		const Index winner_index{ winner % nb_cols, winner / nb_cols };
+		const int g_temp{ search.node(winner).g + 1 };
+
+		const std::array<Index, 4> neighbors{ {
+			Index{ winner_index.x - 1, winner_index.y },
+			Index{ winner_index.x + 1, winner_index.y },
+			Index{ winner_index.x, winner_index.y - 1 },
+			Index{ winner_index.x, winner_index.y + 1 }
+		} };
+
+		for (auto const& neighbor : neighbors)
+		{
+			// Outside the map reads as a wall
+			const int neighbor_cell{ neighbor.y * nb_cols + neighbor.x };
+			if (colliders.is_wall(neighbor.x, neighbor.y) || search.is_closed(neighbor_cell))
+			{
+				continue;
+			}
+
+			search.open(neighbor_cell, g_temp, g_temp + grid_distance(neighbor, goal), winner);
+		}
+	}
+
+	return Grid_search_state::running;
+}
+
+bool find_grid_path(Search_space & search, Collider_grid const& colliders, Index const& start, Index const& goal)
+{
+	int budget{ std::numeric_limits<int>::max() };
+
+	start_grid_search(search, colliders, start, goal);
+	return expand_grid_search(search, colliders, goal, budget) == Grid_search_state::found;
+}
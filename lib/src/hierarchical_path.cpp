@@ -0,0 +1,483 @@
+#include "hierarchical_path.h"
+
+#include <cmath>
+#include <array>
+#include <utility>
+#include <algorithm>
+
+int cell_distance(int cell_1, int cell_2, int nb_cols)
+{
+	return std::abs(cell_1 % nb_cols - cell_2 % nb_cols) + std::abs(cell_1 / nb_cols - cell_2 / nb_cols);
+}
+
+Hierarchical_path::Hierarchical_path()
+{
+}
+
+bool Hierarchical_path::is_open(int x, int y) const
+{
+	return x >= 0 && y >= 0 && x < m_nb_cols && y < m_nb_rows && !m_wall_map[y * m_nb_cols + x];
+}
+
+int Hierarchical_path::cluster_of(int cell) const
+{
+	return (cell / m_nb_cols / m_cluster_size) * m_nb_cluster_cols + (cell % m_nb_cols) / m_cluster_size;
+}
+
+void Hierarchical_path::cluster_bounds(int cluster, int & x1, int & y1, int & x2, int & y2) const
+{
+	x1 = (cluster % m_nb_cluster_cols) * m_cluster_size;
+	y1 = (cluster / m_nb_cluster_cols) * m_cluster_size;
+	x2 = std::min(x1 + m_cluster_size, m_nb_cols) - 1;
+	y2 = std::min(y1 + m_cluster_size, m_nb_rows) - 1;
+}
+
+void Hierarchical_path::rebuild(int nb_cols, int nb_rows, std::vector<bool> const& wall_map, int cluster_size)
+{
+	m_nb_cols = nb_cols;
+	m_nb_rows = nb_rows;
+	m_cluster_size = std::max(cluster_size, 1);
+	m_nb_cluster_cols = (nb_cols + m_cluster_size - 1) / m_cluster_size;
+	m_nb_cluster_rows = (nb_rows + m_cluster_size - 1) / m_cluster_size;
+	m_wall_map = wall_map;
+
+	const int nb_clusters{ m_nb_cluster_cols * m_nb_cluster_rows };
+
+	m_nodes.clear();
+	m_free_nodes.clear();
+	m_cluster_nodes.assign(nb_clusters, {});
+	m_borders.assign(nb_clusters * 2, Border{});
+
+	m_local_distances.assign(m_cluster_size * m_cluster_size, -1);
+	m_local_parents.assign(m_cluster_size * m_cluster_size, -1);
+	m_local_queue.reserve(m_cluster_size * m_cluster_size);
+
+	for (int cluster{ 0 }; cluster < nb_clusters; cluster++)
+	{
+		build_border(cluster, 0);
+		build_border(cluster, 1);
+	}
+
+	for (int cluster{ 0 }; cluster < nb_clusters; cluster++)
+	{
+		build_cluster_edges(cluster);
+	}
+}
+
+void Hierarchical_path::set_wall(Index const& index, bool wall)
+{
+	const int cell{ index.y * m_nb_cols + index.x };
+	if (m_wall_map[cell] == wall)
+	{
+		return;
+	}
+
+	m_wall_map[cell] = wall;
+
+	const int cluster{ cluster_of(cell) };
+	const int cluster_x{ cluster % m_nb_cluster_cols };
+	const int cluster_y{ cluster / m_nb_cluster_cols };
+
+	std::vector<int> touched{ cluster };
+
+	clear_border(cluster, 0);
+	build_border(cluster, 0);
+	clear_border(cluster, 1);
+	build_border(cluster, 1);
+
+	if (cluster_x > 0)
+	{
+		clear_border(cluster - 1, 0);
+		build_border(cluster - 1, 0);
+		touched.push_back(cluster - 1);
+	}
+	if (cluster_y > 0)
+	{
+		clear_border(cluster - m_nb_cluster_cols, 1);
+		build_border(cluster - m_nb_cluster_cols, 1);
+		touched.push_back(cluster - m_nb_cluster_cols);
+	}
+	if (cluster_x < m_nb_cluster_cols - 1) { touched.push_back(cluster + 1); }
+	if (cluster_y < m_nb_cluster_rows - 1) { touched.push_back(cluster + m_nb_cluster_cols); }
+
+	for (auto const& touched_cluster : touched)
+	{
+		build_cluster_edges(touched_cluster);
+	}
+}
+
+int Hierarchical_path::add_node(int cell)
+{
+	int node;
+	if (!m_free_nodes.empty())
+	{
+		node = m_free_nodes.back();
+		m_free_nodes.pop_back();
+	}
+	else
+	{
+		node = static_cast<int>(m_nodes.size());
+		m_nodes.emplace_back();
+	}
+
+	m_nodes[node].cell = cell;
+	m_nodes[node].cluster = cluster_of(cell);
+	m_nodes[node].alive = true;
+	m_nodes[node].edges.clear();
+
+	m_cluster_nodes[m_nodes[node].cluster].push_back(node);
+
+	return node;
+}
+
+void Hierarchical_path::remove_node(int node)
+{
+	auto & cluster_nodes{ m_cluster_nodes[m_nodes[node].cluster] };
+	auto it{ std::find(cluster_nodes.begin(), cluster_nodes.end(), node) };
+	if (it != cluster_nodes.end())
+	{
+		*it = cluster_nodes.back();
+		cluster_nodes.pop_back();
+	}
+
+	m_nodes[node].alive = false;
+	m_nodes[node].edges.clear();
+	m_free_nodes.push_back(node);
+}
+
+void Hierarchical_path::clear_border(int cluster, int side)
+{
+	auto & border_nodes{ m_borders[cluster * 2 + side].nodes };
+	if (border_nodes.empty())
+	{
+		return;
+	}
+
+	// add_node reuses the freed ids, possibly in another cluster : every edge
+	// toward them goes first, from both clusters of the border
+	for (auto const& node : border_nodes)
+	{
+		m_nodes[node].alive = false;
+	}
+
+	const int clusters[2]{ cluster, side == 0 ? cluster + 1 : cluster + m_nb_cluster_cols };
+	for (auto const& touched : clusters)
+	{
+		for (auto const& node : m_cluster_nodes[touched])
+		{
+			auto & edges{ m_nodes[node].edges };
+			edges.erase(std::remove_if(edges.begin(), edges.end(),
+				[this](Edge const& edge) { return !m_nodes[edge.to].alive; }), edges.end());
+		}
+	}
+
+	for (auto const& node : border_nodes)
+	{
+		remove_node(node);
+	}
+
+	border_nodes.clear();
+}
+
+// One entrance per open run of the border, two (at both ends) for long runs
+void Hierarchical_path::build_border(int cluster, int side)
+{
+	const int cluster_x{ cluster % m_nb_cluster_cols };
+	const int cluster_y{ cluster / m_nb_cluster_cols };
+
+	if ((side == 0 && cluster_x == m_nb_cluster_cols - 1) || (side == 1 && cluster_y == m_nb_cluster_rows - 1))
+	{
+		return;
+	}
+
+	int x1, y1, x2, y2;
+	cluster_bounds(cluster, x1, y1, x2, y2);
+
+	const int length{ side == 0 ? y2 - y1 + 1 : x2 - x1 + 1 };
+	const int step_across{ side == 0 ? 1 : m_nb_cols };
+
+	auto border_cell{ [&](int i) { return side == 0 ? (y1 + i) * m_nb_cols + x2 : y2 * m_nb_cols + x1 + i; } };
+	auto crossable{ [&](int i)
+	{
+		const int cell{ border_cell(i) };
+		const int across{ cell + step_across };
+		return !m_wall_map[cell] && !m_wall_map[across];
+	} };
+
+	auto add_entrance{ [&](int i)
+	{
+		const int inside{ add_node(border_cell(i)) };
+		const int outside{ add_node(border_cell(i) + step_across) };
+
+		m_nodes[inside].edges.push_back(Edge{ outside, 1 });
+		m_nodes[outside].edges.push_back(Edge{ inside, 1 });
+
+		m_borders[cluster * 2 + side].nodes.push_back(inside);
+		m_borders[cluster * 2 + side].nodes.push_back(outside);
+	} };
+
+	for (int i{ 0 }; i < length; )
+	{
+		if (!crossable(i))
+		{
+			i++;
+			continue;
+		}
+
+		int end{ i };
+		while (end + 1 < length && crossable(end + 1))
+		{
+			end++;
+		}
+
+		if (end - i + 1 >= 6)
+		{
+			add_entrance(i);
+			add_entrance(end);
+		}
+		else
+		{
+			add_entrance((i + end) / 2);
+		}
+
+		i = end + 1;
+	}
+}
+
+void Hierarchical_path::build_cluster_edges(int cluster)
+{
+	auto const& cluster_nodes{ m_cluster_nodes[cluster] };
+
+	for (auto const& node : cluster_nodes)
+	{
+		auto & edges{ m_nodes[node].edges };
+		edges.erase(std::remove_if(edges.begin(), edges.end(),
+			[this, cluster](Edge const& edge) {return m_nodes[edge.to].cluster == cluster; }), edges.end());
+	}
+
+	for (auto const& node : cluster_nodes)
+	{
+		search_cluster(cluster, m_nodes[node].cell);
+
+		for (auto const& other : cluster_nodes)
+		{
+			const int distance{ local_distance(cluster, m_nodes[other].cell) };
+			if (other != node && distance >= 0)
+			{
+				m_nodes[node].edges.push_back(Edge{ other, distance });
+			}
+		}
+	}
+}
+
+void Hierarchical_path::search_cluster(int cluster, int start_cell)
+{
+	int x1, y1, x2, y2;
+	cluster_bounds(cluster, x1, y1, x2, y2);
+
+	std::fill(m_local_distances.begin(), m_local_distances.end(), -1);
+	m_local_queue.clear();
+
+	auto local{ [&](int x, int y) { return (y - y1) * m_cluster_size + (x - x1); } };
+
+	m_local_distances[local(start_cell % m_nb_cols, start_cell / m_nb_cols)] = 0;
+	m_local_parents[local(start_cell % m_nb_cols, start_cell / m_nb_cols)] = -1;
+	m_local_queue.push_back(start_cell);
+
+	for (size_t head{ 0 }; head < m_local_queue.size(); head++)
+	{
+		const int cell{ m_local_queue[head] };
+		const int x{ cell % m_nb_cols };
+		const int y{ cell / m_nb_cols };
+		const int distance{ m_local_distances[local(x, y)] };
+
+		const std::array<Index, 4> neighbors{ {
+			Index{ x - 1, y },
+			Index{ x + 1, y },
+			Index{ x, y - 1 },
+			Index{ x, y + 1 }
+		} };
+
+		for (auto const& neighbor : neighbors)
+		{
+			if (neighbor.x < x1 || neighbor.x > x2 || neighbor.y < y1 || neighbor.y > y2 || !is_open(neighbor.x, neighbor.y))
+			{
+				continue;
+			}
+
+			const int neighbor_local{ local(neighbor.x, neighbor.y) };
+			if (m_local_distances[neighbor_local] == -1)
+			{
+				m_local_distances[neighbor_local] = distance + 1;
+				m_local_parents[neighbor_local] = cell;
+				m_local_queue.push_back(neighbor.y * m_nb_cols + neighbor.x);
+			}
+		}
+	}
+}
+
+int Hierarchical_path::local_distance(int cluster, int cell) const
+{
+	int x1, y1, x2, y2;
+	cluster_bounds(cluster, x1, y1, x2, y2);
+
+	return m_local_distances[(cell / m_nb_cols - y1) * m_cluster_size + (cell % m_nb_cols - x1)];
+}
+
+// Cells from end_cell back to the start of the last search_cluster run
+void Hierarchical_path::refine(int cluster, int end_cell, std::vector<int> & cells)
+{
+	int x1, y1, x2, y2;
+	cluster_bounds(cluster, x1, y1, x2, y2);
+
+	for (int cell{ end_cell }; cell != -1; cell = m_local_parents[(cell / m_nb_cols - y1) * m_cluster_size + (cell % m_nb_cols - x1)])
+	{
+		if (cells.empty() || cells.back() != cell)
+		{
+			cells.push_back(cell);
+		}
+	}
+}
+
+bool Hierarchical_path::find_path(Index const& start, Index const& goal, std::vector<int> & cells)
+{
+	const int start_cell{ start.y * m_nb_cols + start.x };
+	const int goal_cell{ goal.y * m_nb_cols + goal.x };
+
+	if (start_cell == goal_cell)
+	{
+		cells.push_back(start_cell);
+		return true;
+	}
+
+	if (!is_open(goal.x, goal.y))
+	{
+		return false;
+	}
+
+	const int start_cluster{ cluster_of(start_cell) };
+	const int goal_cluster{ cluster_of(goal_cell) };
+
+	if (start_cluster == goal_cluster)
+	{
+		search_cluster(start_cluster, start_cell);
+		if (local_distance(start_cluster, goal_cell) >= 0)
+		{
+			refine(start_cluster, goal_cell, cells);
+			return true;
+		}
+	}
+
+	// Link start and goal to the entrances of their cluster
+	std::vector<Edge> goal_links;
+	search_cluster(goal_cluster, goal_cell);
+	for (auto const& node : m_cluster_nodes[goal_cluster])
+	{
+		const int distance{ local_distance(goal_cluster, m_nodes[node].cell) };
+		if (distance >= 0) { goal_links.push_back(Edge{ node, distance }); }
+	}
+
+	std::vector<Edge> start_links;
+	search_cluster(start_cluster, start_cell);
+	for (auto const& node : m_cluster_nodes[start_cluster])
+	{
+		const int distance{ local_distance(start_cluster, m_nodes[node].cell) };
+		if (distance >= 0) { start_links.push_back(Edge{ node, distance }); }
+	}
+
+	if (goal_links.empty() || start_links.empty())
+	{
+		return false;
+	}
+
+	const int start_node{ static_cast<int>(m_nodes.size()) };
+	const int goal_node{ start_node + 1 };
+
+	if (m_search.size() < m_nodes.size() + 2)
+	{
+		m_search.resize(m_nodes.size() + 2);
+	}
+
+	auto node_cell{ [&](int node) { return node == start_node ? start_cell : (node == goal_node ? goal_cell : m_nodes[node].cell); } };
+
+	m_search.begin_search();
+	m_search.open(start_node, 0, cell_distance(start_cell, goal_cell, m_nb_cols), -1);
+
+	while (!m_search.empty())
+	{
+		const int current{ m_search.pop() };
+
+		if (current == goal_node)
+		{
+			// Abstract nodes down to the first waypoint, then the refined first segment
+			std::vector<int> nodes;
+			for (int node{ current }; node != -1; node = m_search.node(node).parent)
+			{
+				nodes.push_back(node);
+			}
+
+			for (size_t i{ 0 }; i + 2 < nodes.size(); i++)
+			{
+				if (cells.empty() || cells.back() != node_cell(nodes[i]))
+				{
+					cells.push_back(node_cell(nodes[i]));
+				}
+			}
+
+			refine(start_cluster, node_cell(nodes[nodes.size() - 2]), cells);
+			return true;
+		}
+
+		auto relax{ [&](int to, int cost)
+		{
+			if (!m_search.is_closed(to))
+			{
+				const int g{ m_search.node(current).g + cost };
+				m_search.open(to, g, g + cell_distance(node_cell(to), goal_cell, m_nb_cols), current);
+			}
+		} };
+
+		if (current == start_node)
+		{
+			for (auto const& link : start_links) { relax(link.to, link.cost); }
+			continue;
+		}
+
+		for (auto const& edge : m_nodes[current].edges) { relax(edge.to, edge.cost); }
+
+		if (m_nodes[current].cluster == goal_cluster)
+		{
+			for (auto const& link : goal_links)
+			{
+				if (link.to == current) { relax(goal_node, link.cost); }
+			}
+		}
+	}
+
+	return false;
+}
+
+void Hierarchical_path::abstract_edges(std::vector<Abstract_edge> & edges) const
+{
+	for (auto const& node : m_nodes)
+	{
+		if (!node.alive)
+		{
+			continue;
+		}
+
+		for (auto const& edge : node.edges)
+		{
+			edges.push_back(Abstract_edge{ node.cell, m_nodes[edge.to].cell, edge.cost });
+		}
+	}
+}
+
+size_t Hierarchical_path::nb_abstract_nodes() const
+{
+	return m_nodes.size() - m_free_nodes.size();
+}
+
+Hierarchical_path::~Hierarchical_path()
+{
+}
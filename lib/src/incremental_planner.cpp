@@ -0,0 +1,459 @@
+#include "incremental_planner.h"
+
+#include <cmath>
+#include <algorithm>
+
+Incremental_planner::Incremental_planner()
+{
+}
+
+void Incremental_planner::bind(Collider_grid const* colliders, size_t wall_revision)
+{
+	m_nb_cols = colliders->nb_cols();
+	m_nb_rows = colliders->nb_rows();
+	m_colliders = colliders;
+	m_wall_revision = wall_revision;
+	m_revision_lease = std::make_shared<size_t>(wall_revision);
+
+	const size_t nb_cells{ colliders->nb_cells() };
+	m_g.assign(nb_cells, infinity);
+	m_rhs.assign(nb_cells, infinity);
+	m_key_1.assign(nb_cells, 0);
+	m_key_2.assign(nb_cells, 0);
+	m_heap_index.assign(nb_cells, -1);
+	m_heap.clear();
+
+	m_root = -1;
+	m_position = -1;
+	m_goal = -1;
+	m_dirty = true;
+	m_path.clear();
+}
+
+bool Incremental_planner::is_bound_to(Collider_grid const* colliders) const
+{
+	return m_colliders == colliders && m_g.size() == colliders->nb_cells();
+}
+
+bool Incremental_planner::apply_wall_changes(std::vector<Index> const& wall_changes, size_t first_revision)
+{
+	if (m_wall_revision < first_revision)
+	{
+		return false;
+	}
+
+	for (; m_wall_revision < first_revision + wall_changes.size(); m_wall_revision++)
+	{
+		Index const& index{ wall_changes[m_wall_revision - first_revision] };
+
+		if (m_root != -1)
+		{
+			update_around(index.y * m_nb_cols + index.x);
+		}
+		m_dirty = true;
+	}
+
+	*m_revision_lease = m_wall_revision;
+	return true;
+}
+
+std::weak_ptr<size_t const> Incremental_planner::revision_lease() const
+{
+	return m_revision_lease;
+}
+
+void Incremental_planner::set_start(Index const& start)
+{
+	const int cell{ start.y * m_nb_cols + start.x };
+	if (cell == m_position)
+	{
+		return;
+	}
+
+	m_position = cell;
+
+	// Still on the last path : its tail is a shortest path from here, and the
+	// search tree rooted behind the agent most likely still goes through it
+	auto it{ std::find(m_path.begin(), m_path.end(), cell) };
+	if (it != m_path.end())
+	{
+		if (!m_dirty)
+		{
+			m_path.erase(it + 1, m_path.end());
+		}
+		return;
+	}
+
+	m_root = -1;
+	m_dirty = true;
+}
+
+void Incremental_planner::set_goal(Index const& goal)
+{
+	const int cell{ goal.y * m_nb_cols + goal.x };
+	if (cell == m_goal)
+	{
+		return;
+	}
+
+	m_goal = cell;
+	m_dirty = true;
+
+	if (m_root != -1)
+	{
+		rekey_heap();
+	}
+}
+
+bool Incremental_planner::compute(int max_expansions)
+{
+	m_expanded_nodes = 0;
+
+	if (!m_dirty)
+	{
+		return true;
+	}
+
+	if (m_position == -1 || m_goal == -1)
+	{
+		return false;
+	}
+
+	bool rerooted{ false };
+	while (true)
+	{
+		if (m_root == -1)
+		{
+			reset_root();
+			rerooted = true;
+		}
+
+		if (!repair(max_expansions))
+		{
+			return false;
+		}
+
+		std::vector<int> cells;
+		const bool reachable{ extract_path(cells) };
+		auto it{ std::find(cells.begin(), cells.end(), m_position) };
+
+		// The repaired path no longer goes through the agent : search again from its tile
+		if ((!reachable || it == cells.end()) && m_root != m_position && !rerooted)
+		{
+			m_root = -1;
+			continue;
+		}
+
+		if (reachable && it != cells.end())
+		{
+			cells.erase(it + 1, cells.end());
+			m_path = cells;
+		}
+		else
+		{
+			m_path.clear();
+		}
+
+		m_dirty = false;
+		return true;
+	}
+}
+
+std::vector<int> const& Incremental_planner::path() const
+{
+	return m_path;
+}
+
+bool Incremental_planner::is_up_to_date() const
+{
+	return !m_dirty;
+}
+
+size_t Incremental_planner::expanded_nodes() const
+{
+	return m_expanded_nodes;
+}
+
+size_t Incremental_planner::full_searches() const
+{
+	return m_full_searches;
+}
+
+int Incremental_planner::heuristic(int cell) const
+{
+	return std::abs(cell % m_nb_cols - m_goal % m_nb_cols) + std::abs(cell / m_nb_cols - m_goal / m_nb_cols);
+}
+
+bool Incremental_planner::key_before(int cell_1, int cell_2) const
+{
+	return m_key_1[cell_1] < m_key_1[cell_2] || (m_key_1[cell_1] == m_key_1[cell_2] && m_key_2[cell_1] < m_key_2[cell_2]);
+}
+
+void Incremental_planner::compute_key(int cell)
+{
+	const int cost{ std::min(m_g[cell], m_rhs[cell]) };
+
+	m_key_1[cell] = cost >= infinity ? infinity : cost + heuristic(cell);
+	m_key_2[cell] = cost;
+}
+
+void Incremental_planner::heap_place(size_t heap_index, int cell)
+{
+	m_heap[heap_index] = cell;
+	m_heap_index[cell] = static_cast<int>(heap_index);
+}
+
+void Incremental_planner::heap_sift_up(size_t heap_index)
+{
+	const int cell{ m_heap[heap_index] };
+
+	while (heap_index > 0)
+	{
+		const size_t parent{ (heap_index - 1) / 2 };
+		if (!key_before(cell, m_heap[parent]))
+		{
+			break;
+		}
+
+		heap_place(heap_index, m_heap[parent]);
+		heap_index = parent;
+	}
+
+	heap_place(heap_index, cell);
+}
+
+void Incremental_planner::heap_sift_down(size_t heap_index)
+{
+	const int cell{ m_heap[heap_index] };
+	const size_t size{ m_heap.size() };
+
+	while (true)
+	{
+		size_t child{ heap_index * 2 + 1 };
+		if (child >= size)
+		{
+			break;
+		}
+
+		if (child + 1 < size && key_before(m_heap[child + 1], m_heap[child]))
+		{
+			child++;
+		}
+
+		if (!key_before(m_heap[child], cell))
+		{
+			break;
+		}
+
+		heap_place(heap_index, m_heap[child]);
+		heap_index = child;
+	}
+
+	heap_place(heap_index, cell);
+}
+
+void Incremental_planner::heap_push(int cell)
+{
+	compute_key(cell);
+	m_heap.push_back(cell);
+	heap_sift_up(m_heap.size() - 1);
+}
+
+void Incremental_planner::heap_remove(int cell)
+{
+	const size_t heap_index{ static_cast<size_t>(m_heap_index[cell]) };
+	const int last{ m_heap.back() };
+
+	m_heap.pop_back();
+	m_heap_index[cell] = -1;
+
+	if (heap_index < m_heap.size())
+	{
+		heap_place(heap_index, last);
+		heap_sift_up(heap_index);
+		heap_sift_down(static_cast<size_t>(m_heap_index[last]));
+	}
+}
+
+int Incremental_planner::heap_pop()
+{
+	const int cell{ m_heap.front() };
+	heap_remove(cell);
+
+	return cell;
+}
+
+// The goal moved : every key depends on it
+void Incremental_planner::rekey_heap()
+{
+	for (auto const& cell : m_heap)
+	{
+		compute_key(cell);
+	}
+
+	for (size_t heap_index{ m_heap.size() / 2 }; heap_index-- > 0; )
+	{
+		heap_sift_down(heap_index);
+	}
+}
+
+int Incremental_planner::neighbor_cell(int cell, int direction) const
+{
+	const int x{ cell % m_nb_cols };
+	const int y{ cell / m_nb_cols };
+
+	switch (direction)
+	{
+	case 0: return x > 0 ? cell - 1 : -1;
+	case 1: return x < m_nb_cols - 1 ? cell + 1 : -1;
+	case 2: return y > 0 ? cell - m_nb_cols : -1;
+	case 3: return y < m_nb_rows - 1 ? cell + m_nb_cols : -1;
+	default: return -1;
+	}
+}
+
+void Incremental_planner::update_cell(int cell)
+{
+	if (cell != m_root)
+	{
+		int best{ infinity };
+
+		if (!m_colliders->is_wall(cell))
+		{
+			for (int direction{ 0 }; direction < 4; direction++)
+			{
+				const int neighbor{ neighbor_cell(cell, direction) };
+				if (neighbor != -1 && m_g[neighbor] < infinity)
+				{
+					best = std::min(best, m_g[neighbor] + 1);
+				}
+			}
+		}
+
+		m_rhs[cell] = best;
+	}
+
+	if (m_heap_index[cell] != -1)
+	{
+		heap_remove(cell);
+	}
+
+	if (m_g[cell] != m_rhs[cell])
+	{
+		heap_push(cell);
+	}
+}
+
+void Incremental_planner::update_around(int cell)
+{
+	update_cell(cell);
+
+	for (int direction{ 0 }; direction < 4; direction++)
+	{
+		const int neighbor{ neighbor_cell(cell, direction) };
+		if (neighbor != -1)
+		{
+			update_cell(neighbor);
+		}
+	}
+}
+
+void Incremental_planner::reset_root()
+{
+	std::fill(m_g.begin(), m_g.end(), infinity);
+	std::fill(m_rhs.begin(), m_rhs.end(), infinity);
+	for (auto const& cell : m_heap)
+	{
+		m_heap_index[cell] = -1;
+	}
+	m_heap.clear();
+
+	m_root = m_position;
+	m_rhs[m_root] = 0;
+	heap_push(m_root);
+
+	m_full_searches++;
+}
+
+bool Incremental_planner::repair(int max_expansions)
+{
+	while (!m_heap.empty())
+	{
+		const int top{ m_heap.front() };
+		const int goal_cost{ std::min(m_g[m_goal], m_rhs[m_goal]) };
+		const int goal_key{ goal_cost >= infinity ? infinity : goal_cost };
+
+		const bool top_before_goal{ m_key_1[top] < goal_key || (m_key_1[top] == goal_key && m_key_2[top] < goal_cost) };
+		if (!top_before_goal && m_rhs[m_goal] == m_g[m_goal])
+		{
+			break;
+		}
+
+		if (static_cast<int>(m_expanded_nodes) >= max_expansions)
+		{
+			return false;
+		}
+
+		const int cell{ heap_pop() };
+		m_expanded_nodes++;
+
+		if (m_g[cell] > m_rhs[cell])
+		{
+			m_g[cell] = m_rhs[cell];
+
+			for (int direction{ 0 }; direction < 4; direction++)
+			{
+				const int neighbor{ neighbor_cell(cell, direction) };
+				if (neighbor != -1)
+				{
+					update_cell(neighbor);
+				}
+			}
+		}
+		else
+		{
+			m_g[cell] = infinity;
+			update_around(cell);
+		}
+	}
+
+	return true;
+}
+
+bool Incremental_planner::extract_path(std::vector<int> & cells) const
+{
+	if (m_g[m_goal] >= infinity)
+	{
+		return false;
+	}
+
+	int cell{ m_goal };
+	cells.push_back(cell);
+
+	while (cell != m_root)
+	{
+		int next{ -1 };
+		for (int direction{ 0 }; direction < 4 && next == -1; direction++)
+		{
+			const int neighbor{ neighbor_cell(cell, direction) };
+			if (neighbor != -1 && m_g[neighbor] == m_g[cell] - 1)
+			{
+				next = neighbor;
+			}
+		}
+
+		if (next == -1)
+		{
+			return false;
+		}
+
+		cell = next;
+		cells.push_back(cell);
+	}
+
+	return true;
+}
+
+Incremental_planner::~Incremental_planner()
+{
+}
@@ -0,0 +1,251 @@
+#include "jump_point_search.h"
+
+#include <cmath>
+#include <algorithm>
+
+int manhattan(Index const& a, Index const& b)
+{
+	return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+}
+
+Jump_point_search::Jump_point_search()
+{
+}
+
+bool Jump_point_search::is_open(int x, int y) const
+{
+	return x >= 0 && y >= 0 && x < m_nb_cols && y < m_nb_rows && !m_wall_map[y * m_nb_cols + x];
+}
+
+void Jump_point_search::rebuild(int nb_cols, int nb_rows, std::vector<bool> const& wall_map)
+{
+	m_nb_cols = nb_cols;
+	m_nb_rows = nb_rows;
+	m_wall_map = wall_map;
+
+	const size_t nb_cells{ static_cast<size_t>(nb_cols) * nb_rows };
+	for (auto & run : m_runs) { run.assign(nb_cells, 0); }
+	for (auto & jump : m_jumps) { jump.assign(nb_cells, 0); }
+
+	m_search.resize(nb_cells);
+
+	auto cell{ [nb_cols](int x, int y) { return y * nb_cols + x; } };
+
+	// A vertical move into (x, y) has a forced neighbor when a side cell opens up
+	// while the side cell it came from was blocked
+	auto forced{ [this](int x, int y, int dy)
+	{
+		return (is_open(x - 1, y) && !is_open(x - 1, y - dy)) || (is_open(x + 1, y) && !is_open(x + 1, y - dy));
+	} };
+
+	for (int y{ 0 }; y < nb_rows; y++)
+	{
+		for (int x{ 1 }; x < nb_cols; x++)
+		{
+			m_runs[left][cell(x, y)] = is_open(x - 1, y) ? m_runs[left][cell(x - 1, y)] + 1 : 0;
+		}
+		for (int x{ nb_cols - 2 }; x >= 0; x--)
+		{
+			m_runs[right][cell(x, y)] = is_open(x + 1, y) ? m_runs[right][cell(x + 1, y)] + 1 : 0;
+		}
+	}
+
+	for (int x{ 0 }; x < nb_cols; x++)
+	{
+		for (int y{ 1 }; y < nb_rows; y++)
+		{
+			m_runs[up][cell(x, y)] = is_open(x, y - 1) ? m_runs[up][cell(x, y - 1)] + 1 : 0;
+
+			if (is_open(x, y - 1))
+			{
+				const int next{ m_jumps[up][cell(x, y - 1)] };
+				m_jumps[up][cell(x, y)] = forced(x, y - 1, -1) ? 1 : (next > 0 ? next + 1 : 0);
+			}
+		}
+		for (int y{ nb_rows - 2 }; y >= 0; y--)
+		{
+			m_runs[down][cell(x, y)] = is_open(x, y + 1) ? m_runs[down][cell(x, y + 1)] + 1 : 0;
+
+			if (is_open(x, y + 1))
+			{
+				const int next{ m_jumps[down][cell(x, y + 1)] };
+				m_jumps[down][cell(x, y)] = forced(x, y + 1, 1) ? 1 : (next > 0 ? next + 1 : 0);
+			}
+		}
+	}
+
+	// A horizontal jump stops where one of the vertical jumps finds something
+	auto vertical_hit{ [this, &cell](int x, int y)
+	{
+		return m_jumps[up][cell(x, y)] > 0 || m_jumps[down][cell(x, y)] > 0;
+	} };
+
+	for (int y{ 0 }; y < nb_rows; y++)
+	{
+		for (int x{ 1 }; x < nb_cols; x++)
+		{
+			if (is_open(x - 1, y))
+			{
+				const int next{ m_jumps[left][cell(x - 1, y)] };
+				m_jumps[left][cell(x, y)] = vertical_hit(x - 1, y) ? 1 : (next > 0 ? next + 1 : 0);
+			}
+		}
+		for (int x{ nb_cols - 2 }; x >= 0; x--)
+		{
+			if (is_open(x + 1, y))
+			{
+				const int next{ m_jumps[right][cell(x + 1, y)] };
+				m_jumps[right][cell(x, y)] = vertical_hit(x + 1, y) ? 1 : (next > 0 ? next + 1 : 0);
+			}
+		}
+	}
+}
+
+int Jump_point_search::jump_vertical(int x, int y, int dy, Index const& goal) const
+{
+	const int cell{ y * m_nb_cols + x };
+	const Direction dir{ dy > 0 ? down : up };
+
+	int distance{ m_jumps[dir][cell] > 0 ? m_jumps[dir][cell] : -1 };
+
+	const int goal_distance{ (goal.y - y) * dy };
+	if (goal.x == x && goal_distance > 0 && goal_distance <= m_runs[dir][cell] &&
+		(distance == -1 || goal_distance < distance))
+	{
+		distance = goal_distance;
+	}
+
+	return distance == -1 ? -1 : cell + distance * dy * m_nb_cols;
+}
+
+int Jump_point_search::jump_horizontal(int x, int y, int dx, Index const& goal) const
+{
+	const int cell{ y * m_nb_cols + x };
+	const Direction dir{ dx > 0 ? right : left };
+
+	int distance{ m_jumps[dir][cell] > 0 ? m_jumps[dir][cell] : -1 };
+
+	// The goal row, or the goal column when the goal is in straight sight from it
+	const int goal_distance{ (goal.x - x) * dx };
+	if (goal_distance > 0 && goal_distance <= m_runs[dir][cell] && (distance == -1 || goal_distance < distance))
+	{
+		const int column_cell{ y * m_nb_cols + goal.x };
+		const int vertical_distance{ std::abs(goal.y - y) };
+
+		if (goal.y == y || m_runs[goal.y > y ? down : up][column_cell] >= vertical_distance)
+		{
+			distance = goal_distance;
+		}
+	}
+
+	return distance == -1 ? -1 : cell + distance * dx;
+}
+
+void Jump_point_search::push_jump(int from, int to, Index const& goal)
+{
+	if (to == -1 || m_search.is_closed(to))
+	{
+		return;
+	}
+
+	const Index from_index{ from % m_nb_cols, from / m_nb_cols };
+	const Index to_index{ to % m_nb_cols, to / m_nb_cols };
+
+	const int g{ m_search.node(from).g + manhattan(from_index, to_index) };
+	m_search.open(to, g, g + manhattan(to_index, goal), from);
+}
+
+bool Jump_point_search::find_path(Index const& start, Index const& goal, std::vector<int> & cells)
+{
+	const int start_cell{ start.y * m_nb_cols + start.x };
+	const int goal_cell{ goal.y * m_nb_cols + goal.x };
+
+	m_expanded_nodes = 0;
+
+	if (start_cell == goal_cell)
+	{
+		cells.push_back(start_cell);
+		return true;
+	}
+
+	if (!is_open(goal.x, goal.y))
+	{
+		return false;
+	}
+
+	m_search.begin_search();
+	m_search.open(start_cell, 0, manhattan(start, goal), -1);
+
+	while (!m_search.empty())
+	{
+		const int current{ m_search.pop() };
+		m_expanded_nodes++;
+
+		if (current == goal_cell)
+		{
+			for (int cell{ current }; cell != start_cell; )
+			{
+				const int parent{ m_search.node(cell).parent };
+				const int step{ std::abs(parent - cell) < m_nb_cols ? (parent > cell ? 1 : -1) : (parent > cell ? m_nb_cols : -m_nb_cols) };
+
+				for (; cell != parent; cell += step)
+				{
+					cells.push_back(cell);
+				}
+			}
+			cells.push_back(start_cell);
+
+			return true;
+		}
+
+		const int x{ current % m_nb_cols };
+		const int y{ current / m_nb_cols };
+		const int parent{ m_search.node(current).parent };
+
+		if (parent == -1)
+		{
+			push_jump(current, jump_horizontal(x, y, -1, goal), goal);
+			push_jump(current, jump_horizontal(x, y, 1, goal), goal);
+			push_jump(current, jump_vertical(x, y, -1, goal), goal);
+			push_jump(current, jump_vertical(x, y, 1, goal), goal);
+			continue;
+		}
+
+		const int parent_x{ parent % m_nb_cols };
+		const int parent_y{ parent / m_nb_cols };
+
+		if (parent_y == y)
+		{
+			const int dx{ x > parent_x ? 1 : -1 };
+
+			push_jump(current, jump_horizontal(x, y, dx, goal), goal);
+			push_jump(current, jump_vertical(x, y, -1, goal), goal);
+			push_jump(current, jump_vertical(x, y, 1, goal), goal);
+		}
+		else
+		{
+			const int dy{ y > parent_y ? 1 : -1 };
+
+			push_jump(current, jump_vertical(x, y, dy, goal), goal);
+
+			for (int side : { -1, 1 })
+			{
+				if (is_open(x + side, y) && !is_open(x + side, y - dy))
+				{
+					push_jump(current, jump_horizontal(x, y, side, goal), goal);
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+size_t Jump_point_search::expanded_nodes() const
+{
+	return m_expanded_nodes;
+}
+
+Jump_point_search::~Jump_point_search()
+{
+}
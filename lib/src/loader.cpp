@@ -236,10 +236,23 @@ Mob_infos Loader::extract_ennemie_infos(tinyxml2::XMLElement * ennemie_element)
 		anim_infos = extract_animation_infos(animation_element);
 	}
 
+	std::string pathing;
+	tinyxml2::XMLElement *pathing_element{ ennemie_element->FirstChildElement("Pathing") };
+	if (pathing_element)
+	{
+		const char * mode;
+		if (!xml_successfull(pathing_element->QueryStringAttribute("mode", &mode)))
+		{
+			throw LoaderException{ "Search of string in 'mode' failed" };
+		}
+		pathing = mode;
+	}
+
 	return Mob_infos{ extract_position(position_element),
 						extract_size(size_element),
 						extract_speed(speed_element),
-						anim_infos };
+						anim_infos,
+						pathing };
 }
 
 Animation_infos Loader::extract_animation_infos(tinyxml2::XMLElement * animation_element)
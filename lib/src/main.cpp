@@ -4,17 +4,25 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <memory>
+#include <cmath>
 
 #include "map.h"
 #include "a_star.h"
 #include "loader.h"
+#include "spatial_grid.h"
+#include "tile_index.h"
+#include "path_service.h"
+#include "corner_path.h"
+#include "box_batch.h"
+#include "sweep_and_prune.h"
 #include "game_structures.h"
+#include "entity.h"
+#include "registry.h"
+#include "archetype.h"
 
 namespace ecs
 {
-	using Id = size_t;
-	using Entities = std::vector<Id>;
-
 	struct Physic
 	{
 		Position position_data;
@@ -25,15 +33,8 @@ namespace ecs
 		Physic physic_data;
 		Id id_data;
 	};
-	using Physics = std::vector<Physic_component>;
 
 	using Celerity = Position;
-	struct Celerity_component
-	{
-		Celerity celerity_data;
-		Id id_data;
-	};
-	using Celerities = std::vector<Celerity_component>;
 
 	using Speed = float;
 	struct Speed_component
@@ -41,7 +42,6 @@ namespace ecs
 		Speed speed_data;
 		Id id_data;
 	};
-	using Speeds = std::vector<Speed_component>;
 
 	using Health = int;
 	struct Health_component
@@ -49,7 +49,6 @@ namespace ecs
 		Health health_data;
 		Id id_data;
 	};
-	using Healths = std::vector<Health_component>;
 
 	enum class Type { mob, point };
 	struct Type_component
@@ -57,8 +56,6 @@ namespace ecs
 		Type type_data;
 		Id id_data;
 	};
-	using Types = std::vector<Type_component>;
-
 
 	using Sprite = sf::Sprite;
 	struct Sprite_component
@@ -66,7 +63,6 @@ namespace ecs
 		Sprite sprite_data;
 		Id id_data;
 	};
-	using Sprites = std::vector<Sprite_component>;
 
 	enum class Direction { right, bottom, left, top };
 	struct Animation
@@ -82,32 +78,122 @@ namespace ecs
 		Animation animation_data;
 		Id id_data;
 	};
-	using Animations = std::vector<Animation_component>;
 
 	enum class Behavior { aggressive };
+	// How an ai gets its next tile : a new search every frame, the shared flow field,
+	// its own incremental planner, its last path while it still applies, the path
+	// service workers, searches spread over frames under a shared node budget, or
+	// a plan in space and time around the other cooperative ais
+	enum class Pathing { search, flow_field, incremental, cached, async, time_sliced, cooperative };
 	struct Ai
 	{
 		Behavior behavior;
+		Pathing pathing;
 	};
 	struct Ai_component
 	{
 		Ai ai_data;
 		Id id_data;
 	};
-	using Ais = std::vector<Ai_component>;
+
+	// Search state kept between frames, one planner per hitbox corner like choose_path
+	struct Planner
+	{
+		Incremental_planner corners[2];
+	};
+	struct Planner_component
+	{
+		Planner planner_data;
+		Id id_data;
+	};
+
+	// Last path of each hitbox corner
+	struct Path_memory
+	{
+		Path_cache corners[2];
+	};
+	struct Path_memory_component
+	{
+		Path_memory path_memory_data;
+		Id id_data;
+	};
+
+	// Paths asked to the path service for each hitbox corner, the old ones are
+	// followed until the new ones arrive
+	struct Path_request
+	{
+		Path_service::Ticket tickets[2]{ Path_service::no_ticket, Path_service::no_ticket };
+		std::vector<Position> paths[2];
+	};
+	struct Path_request_component
+	{
+		Path_request path_request_data;
+		Id id_data;
+	};
+
+	// Searches of each hitbox corner, stepped by schedule_sliced_searches, and the
+	// last paths they found
+	struct Sliced_path
+	{
+		Sliced_search searches[2];
+		std::vector<Position> paths[2];
+	};
+	struct Sliced_path_component
+	{
+		Sliced_path sliced_path_data;
+		Id id_data;
+	};
+
+	// Path buffers of each hitbox corner, sized once for the longest path of the map
+	// so that choose_buffered_step never allocates
+	struct Path_scratch
+	{
+		Path_buffer corners[2];
+	};
+	struct Path_scratch_component
+	{
+		Path_scratch path_scratch_data;
+		Id id_data;
+	};
+
+	// Entities that move, the player and the ghosts : stored by chunk, Physic and
+	// Celerity as columns. The other entities keep their Physic in the registry.
+	using Movers = Archetype<Physic, Celerity>;
+
+	using Components = Registry<Physic_component, Speed_component, Health_component,
+		Type_component, Sprite_component, Animation_component, Ai_component, Planner_component, Path_memory_component,
+		Path_request_component, Sliced_path_component, Path_scratch_component>;
+
+	// How update_collisions finds the boxes near the target : the spatial grid and
+	// tile index, or a sort and sweep over every box kept sorted between frames
+	// (better when entities cluster, like points in rows or ghosts in their pen)
+	enum class Broadphase { grid, sweep_and_prune };
 
 	struct Stage
 	{
 		Map _map;
-		Entities _entities;
-		Physics _physics;
-		Celerities _celerities;
-		Speeds _speeds;
-		Healths _healths;
-		Types _types;
-		Sprites _sprites;
-		Animations _animations;
-		Ais _ais;
+		Spatial_grid _grid;
+		Tile_index _statics;
+		Components _components;
+		Movers _movers;
+		// Tiles held by the cooperative ais, planned again every frame
+		Reservation_table _reservations;
+		// Started with the first async ai, its workers idle otherwise
+		std::unique_ptr<Path_service> _path_service;
+
+		Broadphase _broadphase{ Broadphase::grid };
+		Sweep_and_prune _sweep;
+		// Overlaps that began or ended during the last sweep
+		std::vector<Overlap_event> _overlap_events;
+
+		// Scratch of update_collisions, cleared on each call but keeping its capacity
+		std::vector<Id> _candidates;
+		std::vector<Id> _tested;
+		Box_batch _boxes;
+		std::vector<size_t> _hits;
+		std::vector<std::pair<Id, Id>> _pairs;
+
+		std::vector<Id> _destroy_queue;
 	};
 
 	bool check_collision(Position const& b1_p, Size const& b1_s, Position const& b2_p, Size const& b2_s)
@@ -127,32 +213,46 @@ namespace ecs
 		return static_cast<int>(dir);
 	}
 
-	template <typename Collection>
-	typename Collection::value_type & get_component(Collection & collection, Id const& id)
+	Id create_entity(Stage & stage)
+	{
+		return stage._components.create();
+	}
+
+	bool is_alive(Stage const& stage, Id const& id)
 	{
-		auto it = std::find_if(begin(collection), end(collection),
-			[id](auto p) {return(p.id_data == id); });
+		return stage._components.alive(id);
+	}
+
+	// Movers first, then the Physic pool
+	Physic * find_physic(Stage & stage, Id const& id)
+	{
+		if (stage._movers.contains(id))
+		{
+			return &stage._movers.get<Physic>(id);
+		}
 
-		assert(it != end(collection));
+		Physic_component * physic_component{ stage._components.try_get<Physic_component>(id) };
 
-		return (*it);
+		return physic_component ? &physic_component->physic_data : nullptr;
 	}
 
-	Id create_entity(Stage const& stage)
+	Physic & get_physic(Stage & stage, Id const& id)
 	{
-		return stage._entities.empty() ? 1 : stage._entities.size() + 1;;
+		Physic * physic{ find_physic(stage, id) };
+		assert(physic);
+
+		return *physic;
 	}
 
 	Id add_mob(Stage & stage, Physic const& physic, Speed const& spd, sf::Texture const& texture)
 	{
 		const auto id{ create_entity(stage) };
-		stage._entities.push_back(id);
-		stage._physics.push_back(Physic_component{ physic, id });
-		stage._celerities.push_back(Celerity_component{ Celerity{ 0, 0 }, id });
-		stage._speeds.push_back(Speed_component{ spd, id });
-		stage._healths.push_back(Health_component{ 3, id });
-		stage._types.push_back(Type_component{ Type::mob, id });
-		stage._sprites.push_back(Sprite_component{ Sprite{ texture }, id });
+		stage._movers.push_back(id, physic, Celerity{ 0, 0 });
+		stage._components.add(Speed_component{ spd, id });
+		stage._components.add(Health_component{ 3, id });
+		stage._components.add(Type_component{ Type::mob, id });
+		stage._components.add(Sprite_component{ Sprite{ texture }, id });
+		stage._grid.insert(id, physic.position_data, physic.size_data);
 
 		return id;
 	}
@@ -160,101 +260,118 @@ namespace ecs
 	Id add_point(Stage & stage, Physic const& physic, sf::Texture const& texture)
 	{
 		const auto id{ create_entity(stage) };
-		stage._entities.push_back(id);
-		stage._physics.push_back(Physic_component{ physic, id });
-		stage._types.push_back(Type_component{ Type::point, id });
-		stage._sprites.push_back(Sprite_component{ Sprite{ texture }, id });
+		stage._components.add(Physic_component{ physic, id });
+		stage._components.add(Type_component{ Type::point, id });
+		stage._components.add(Sprite_component{ Sprite{ texture }, id });
+		stage._statics.insert(id, physic.position_data, physic.size_data);
 
 		return id;
 	}
 
 	void add_animation(Stage & stage, Id const& target, Animation const& anim)
 	{
-		stage._animations.push_back(Animation_component{ anim, target });
-	}
-
-	void add_ai(Stage & stage, Id const& target, Behavior const& behavior)
-	{
-		stage._ais.push_back(Ai_component{ Ai{ behavior }, target });
+		stage._components.add(Animation_component{ anim, target });
 	}
 
-	void remove_entity(Stage & stage, Id const& id)
+	void add_ai(Stage & stage, A_star & path_finding, Id const& target, Behavior const& behavior, Pathing const& pathing)
 	{
-		const auto entities_it{ std::remove(stage._entities.begin(), stage._entities.end(), id) };
-		stage._entities.erase(entities_it, stage._entities.end());
-
-		const auto physics_it{ std::remove_if(stage._physics.begin(), stage._physics.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._physics.erase(physics_it, stage._physics.end());
-
-		const auto celerities_it{ std::remove_if(stage._celerities.begin(), stage._celerities.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._celerities.erase(celerities_it, stage._celerities.end());
+		stage._components.add(Ai_component{ Ai{ behavior, pathing }, target });
 
-		const auto speeds_it{ std::remove_if(stage._speeds.begin(), stage._speeds.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._speeds.erase(speeds_it, stage._speeds.end());
-
-		const auto healths_it{ std::remove_if(stage._healths.begin(), stage._healths.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._healths.erase(healths_it, stage._healths.end());
-
-		const auto types_it{ std::remove_if(stage._types.begin(), stage._types.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._types.erase(types_it, stage._types.end());
+		if (pathing == Pathing::incremental)
+		{
+			stage._components.add(Planner_component{ Planner{}, target });
+		}
+		else if (pathing == Pathing::cached)
+		{
+			stage._components.add(Path_memory_component{ Path_memory{}, target });
+		}
+		else if (pathing == Pathing::async)
+		{
+			if (!stage._path_service)
+			{
+				stage._path_service = std::make_unique<Path_service>(stage._map.get_loaded_infos(), 2);
+				path_finding.set_path_service(stage._path_service.get());
+			}
 
-		const auto sprites_it{ std::remove_if(stage._sprites.begin(), stage._sprites.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._sprites.erase(sprites_it, stage._sprites.end());
+			stage._components.add(Path_request_component{ Path_request{}, target });
+		}
+		else if (pathing == Pathing::time_sliced)
+		{
+			stage._components.add(Sliced_path_component{ Sliced_path{}, target });
+		}
+		else if (pathing == Pathing::search || pathing == Pathing::flow_field)
+		{
+			// The flow field falls back to a search when it does not target the player
+			const size_t capacity{ path_finding.max_path_length() };
 
-		const auto animations_it{ std::remove_if(stage._animations.begin(), stage._animations.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._animations.erase(animations_it, stage._animations.end());
+			stage._components.add(Path_scratch_component{ Path_scratch{ { Path_buffer{ capacity }, Path_buffer{ capacity } } }, target });
+		}
+	}
 
-		const auto ai_it{ std::remove_if(stage._ais.begin(), stage._ais.end(),
-			[id](auto p) {return (p.id_data == id); }) };
-		stage._ais.erase(ai_it, stage._ais.end());
+	void remove_entity(Stage & stage, Id const& id)
+	{
+		if (stage._components.destroy(id))
+		{
+			stage._movers.erase(id);
+			stage._grid.remove(id);
+			stage._statics.remove(id);
+			stage._sweep.remove(id);
+		}
 	}
 
 	void remove_entities(Stage & stage, std::vector<Id> & entity_to_remove)
 	{
-		for (auto & entity : entity_to_remove)
+		stage._components.destroy(entity_to_remove);
+
+		for (auto const& id : entity_to_remove)
 		{
-			remove_entity(stage, entity);
+			stage._movers.erase(id);
+			stage._grid.remove(id);
+			stage._statics.remove(id);
+			stage._sweep.remove(id);
 		}
 
 		entity_to_remove.clear();
 	}
 
-	void set_celerity(Stage & stage, Id const& id, Celerity const& new_celerity)
+	// Safe to call while iterating a pool : the entity stays alive until flush_destroyed
+	void destroy_later(Stage & stage, Id const& id)
 	{
-		auto & celerity_component{ get_component(stage._celerities, id) };
+		stage._destroy_queue.push_back(id);
+	}
+
+	void flush_destroyed(Stage & stage)
+	{
+		remove_entities(stage, stage._destroy_queue);
+	}
 
-		celerity_component.celerity_data = new_celerity;
+	void set_celerity(Stage & stage, Id const& id, Celerity const& new_celerity)
+	{
+		stage._movers.get<Celerity>(id) = new_celerity;
 	}
 
 	void set_direction(Stage & stage, Id const& target, Direction const& dir)
 	{
-		auto & animation_component{ get_component(stage._animations, target) };
+		auto & animation_component{ stage._components.get<Animation_component>(target) };
 
 		animation_component.animation_data.dir = dir;
 	}
 
 	void get_damage(Stage & level, Id const& target, Health damages_token)
 	{
-		auto & health_target{ get_component(level._healths, target).health_data };
+		auto & health_target{ level._components.get<Health_component>(target).health_data };
 		health_target -= damages_token;
 		//CHECK IF DEAD
 	}
 
-	void entities_interaction(Stage & level, Id const& entity_1, Id const& entity_2, std::vector<Id> & entity_to_remove)
+	void entities_interaction(Stage & level, Id const& entity_1, Id const& entity_2)
 	{
-		auto entity_1_t{ get_component(level._types, entity_1) };
-		auto entity_2_t{ get_component(level._types, entity_2) };
+		auto entity_1_t{ level._components.get<Type_component>(entity_1) };
+		auto entity_2_t{ level._components.get<Type_component>(entity_2) };
 
 		if (entity_1_t.type_data == Type::mob && entity_2_t.type_data == Type::point)
 		{
-			entity_to_remove.push_back(entity_2);
+			destroy_later(level, entity_2);
 		}
 		else if (entity_1_t.type_data == Type::mob && entity_2_t.type_data == Type::mob)
 		{
@@ -265,80 +382,378 @@ namespace ecs
 
 	std::vector<Position> choose_path(A_star & path_finding, Position const& pos_target, Size const& size_target, Position const& final_pos)
 	{
-		std::vector<Position> path_1{ path_finding.create_center_path(pos_target.x, pos_target.y, final_pos.x, final_pos.y) };
-		std::vector<Position> path_2{ path_finding.create_center_path(pos_target.x + size_target.width, pos_target.y + size_target.height, final_pos.x, final_pos.y) };
+		std::vector<Position> paths[2];
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			paths[i] = path_finding.create_center_path(pos.x, pos.y, final_pos.x, final_pos.y);
+			return paths[i].size();
+		}) };
+
+		return std::move(paths[corner]);
+	}
+
+	// Read from the shared flow field in O(1)
+	bool choose_flow_step(A_star const& path_finding, Position const& pos_target, Size const& size_target, Position & next_position)
+	{
+		Position corners[2];
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			corners[i] = pos;
+			return path_finding.flow_distance(pos.x, pos.y);
+		}) };
+
+		return path_finding.flow_next_position(corners[corner].x, corners[corner].y, next_position);
+	}
+
+	// Each corner repairing its own planner
+	std::vector<Position> choose_planned_path(A_star & path_finding, Planner & planner, Position const& pos_target, Size const& size_target, Position const& final_pos)
+	{
+		std::vector<Position> paths[2];
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			paths[i] = path_finding.create_incremental_path(planner.corners[i], pos.x, pos.y, final_pos.x, final_pos.y);
+			return paths[i].size();
+		}) };
+
+		return std::move(paths[corner]);
+	}
+
+	// Each corner reusing its last path
+	std::vector<Position> choose_cached_path(A_star & path_finding, Path_memory & memory, Position const& pos_target, Size const& size_target, Position const& final_pos)
+	{
+		std::vector<Position> paths[2];
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			paths[i] = path_finding.create_cached_path(memory.corners[i], pos.x, pos.y, final_pos.x, final_pos.y);
+			return paths[i].size();
+		}) };
+
+		return std::move(paths[corner]);
+	}
+
+	// Drop the part of a followed path already walked, or the whole path once the corner left it
+	void drop_walked_steps(std::vector<Position> & path, Position const& corner, Size const& tile_size)
+	{
+		auto same_tile{ [&tile_size](Position const& a, Position const& b)
+		{
+			return std::floor(a.x / tile_size.width) == std::floor(b.x / tile_size.width) &&
+				std::floor(a.y / tile_size.height) == std::floor(b.y / tile_size.height);
+		} };
+
+		auto it{ std::find_if(path.rbegin(), path.rend(), [&same_tile, &corner](Position const& step) { return same_tile(step, corner); }) };
+		path.erase(it.base(), path.end());
+	}
+
+	// On the last paths sent by the path service. A new request is sent for a
+	// corner as soon as its previous one is answered.
+	bool choose_async_step(Path_service & path_service, Path_request & request, Id const& id, Position const& pos_target, Size const& size_target, Position const& final_pos, Size const& tile_size, Position & next_position)
+	{
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			auto & ticket{ request.tickets[i] };
+			auto & path{ request.paths[i] };
+
+			if (ticket != Path_service::no_ticket && path_service.poll(ticket, path))
+			{
+				ticket = Path_service::no_ticket;
+			}
+
+			if (ticket == Path_service::no_ticket)
+			{
+				ticket = path_service.submit(id, pos, final_pos);
+			}
+
+			drop_walked_steps(path, pos, tile_size);
+			return path.size();
+		}) };
+
+		return next_step(request.paths[corner], next_position);
+	}
+
+	bool choose_sliced_step(Sliced_path & sliced_path, Position const& pos_target, Size const& size_target, Size const& tile_size, Position & next_position)
+	{
+		const int corner{ longer_corner(pos_target, size_target, [&](int i, Position const& pos)
+		{
+			drop_walked_steps(sliced_path.paths[i], pos, tile_size);
+			return sliced_path.paths[i].size();
+		}) };
+
+		return next_step(sliced_path.paths[corner], next_position);
+	}
+
+	// Nodes every time-sliced search of the frame share
+	const int sliced_node_budget{ 512 };
+	// Steps a cooperative ai plans ahead
+	const int cooperative_window{ 8 };
+
+	// The ais planned earlier in the frame have priority
+	bool choose_cooperative_step(Stage & stage, A_star & path_finding, Id const& id, Position const& pos_target, Size const& size_target, Position const& final_pos, Position & next_position)
+	{
+		const Position corner_2{ pos_target.x + size_target.width, pos_target.y + size_target.height };
+		const std::vector<Position> path{ path_finding.create_cooperative_path(stage._reservations, id, pos_target, corner_2, final_pos, cooperative_window) };
+
+		return next_step(path, next_position);
+	}
+
+	// Starts a search for each idle corner, shares the node budget between the
+	// running searches, then hands the finished ones over to their agents
+	void schedule_sliced_searches(Stage & stage, A_star & path_finding, Position const& final_pos, int budget)
+	{
+		std::vector<Sliced_search *> running;
+
+		for (auto & entity : stage._components.pool<Sliced_path_component>())
+		{
+			Physic const* physic{ find_physic(stage, entity.id_data) };
+			if (physic == nullptr)
+			{
+				continue;
+			}
+
+			Position const& pos{ physic->position_data };
+			Size const& size{ physic->size_data };
+			const Position corners[2]{ pos, Position{ pos.x + size.width, pos.y + size.height } };
 
-		if (path_1.size() > path_2.size())
+			for (int i{ 0 }; i < 2; i++)
+			{
+				auto & search{ entity.sliced_path_data.searches[i] };
+				if (!search.is_running())
+				{
+					path_finding.start_sliced_search(search, corners[i].x, corners[i].y, final_pos.x, final_pos.y);
+				}
+
+				if (search.is_running())
+				{
+					running.push_back(&search);
+				}
+			}
+		}
+
+		// What a finished search leaves goes to the others
+		while (budget > 0 && !running.empty())
 		{
-			return path_1;
+			const int slice{ std::max(1, budget / static_cast<int>(running.size())) };
+
+			for (auto & search : running)
+			{
+				budget -= search->step(std::min(slice, budget));
+				if (budget <= 0)
+				{
+					break;
+				}
+			}
+
+			running.erase(std::remove_if(running.begin(), running.end(), [](Sliced_search const* search) { return !search->is_running(); }), running.end());
 		}
-		else
+
+		for (auto & entity : stage._components.pool<Sliced_path_component>())
 		{
-			return path_2;
+			for (int i{ 0 }; i < 2; i++)
+			{
+				auto & search{ entity.sliced_path_data.searches[i] };
+				if (!search.is_running())
+				{
+					path_finding.sliced_search_path(search, entity.sliced_path_data.paths[i]);
+					search.cancel();
+				}
+			}
 		}
+	}
+
+	// Hits and misses of every ai path cache of the stage
+	void path_cache_stats(Stage & stage, size_t & hits, size_t & misses)
+	{
+		hits = 0;
+		misses = 0;
 
+		for (auto const& entity : stage._components.pool<Path_memory_component>())
+		{
+			for (auto const& cache : entity.path_memory_data.corners)
+			{
+				hits += cache.hits();
+				misses += cache.misses();
+			}
+		}
 	}
 
+	// Swept against the tiles : a long frame stops the box on the first wall instead
+	// of dropping the move or going through
+	void move_physic(Map const& map, Physic & physic, Celerity const& celerity, long long delta_t)
+	{
+		const Sweep_result sweep{ map.sweep(physic.position_data, physic.size_data, celerity.x * delta_t, celerity.y * delta_t) };
+
+		physic.position_data = sweep.position;
+	}
+
+	// Walks the mover columns chunk by chunk
 	void update_positions(Stage & stage, long long delta_t)
 	{
-		for (auto & celerity : stage._celerities)
+		stage._movers.for_each_chunk([&stage, delta_t](size_t count, Id const* ids, Physic * physics, Celerity * celerities)
 		{
-			auto & physic_component{ get_component(stage._physics, celerity.id_data) };
+			for (size_t i{ 0 }; i < count; i++)
+			{
+				move_physic(stage._map, physics[i], celerities[i], delta_t);
+				stage._grid.update(ids[i], physics[i].position_data, physics[i].size_data);
+
+				celerities[i].x = 0;
+				celerities[i].y = 0;
+			}
+		});
+	}
+
+	// Mobs against each other : every pair sharing a grid cell, then a box test
+	void update_mob_collisions(Stage & stage)
+	{
+		auto & pairs{ stage._pairs };
+		pairs.clear();
+		stage._grid.find_pairs(pairs);
 
-			float next_x_position{ physic_component.physic_data.position_data.x + celerity.celerity_data.x * delta_t };
-			float next_y_position{ physic_component.physic_data.position_data.y + celerity.celerity_data.y * delta_t };
+		for (auto const& pair : pairs)
+		{
+			Physic const* physic_1{ find_physic(stage, pair.first) };
+			Physic const* physic_2{ find_physic(stage, pair.second) };
 
-			if (!stage._map.check_collision(next_x_position, next_y_position, physic_component.physic_data.size_data.width, physic_component.physic_data.size_data.height))
+			if (physic_1 && physic_2 &&
+				check_collision(physic_1->position_data, physic_1->size_data,
+					physic_2->position_data, physic_2->size_data))
 			{
-				physic_component.physic_data.position_data.x = next_x_position;
-				physic_component.physic_data.position_data.y = next_y_position;
+				entities_interaction(stage, pair.first, pair.second);
 			}
-
-			celerity.celerity_data.x = 0;
-			celerity.celerity_data.y = 0;
 		}
 	}
 
+	// The target against the static entities around it, the mobs are paired by update_mob_collisions
 	void update_collisions(Stage & stage, Id const& target)
 	{
-		auto target_physic{ get_component(stage._physics, target) };
+		const Physic target_physic{ get_physic(stage, target) };
+
+		auto & candidates{ stage._candidates };
+		candidates.clear();
+		stage._statics.query(target_physic.position_data, target_physic.size_data, candidates);
+
+		// Boxes of the candidates tested in one batch, points to pick up included
+		auto & tested{ stage._tested };
+		auto & boxes{ stage._boxes };
+		tested.clear();
+		boxes.clear();
+		for (auto const& candidate : candidates)
+		{
+			Physic const* entity_p{ find_physic(stage, candidate) };
+
+			if (candidate != target && entity_p)
+			{
+				tested.push_back(candidate);
+				boxes.push_back(entity_p->position_data, entity_p->size_data);
+			}
+		}
 
-		std::vector<Id> entity_to_remove;
+		auto & hits{ stage._hits };
+		hits.clear();
+		boxes.overlapping(target_physic.position_data, target_physic.size_data, hits);
 
-		for (auto & entity_p : stage._physics)
+		for (auto const& hit : hits)
 		{
-			if (entity_p.id_data != target)
-			{
+			entities_interaction(stage, target, tested[hit]);
+		}
+	}
+
+	// Same interactions as update_collisions, read from the pairs the sweep keeps
+	// overlapping between frames
+	void update_collisions_sweep(Stage & stage, Id const& target)
+	{
+		for (auto const& physic_component : stage._components.pool<Physic_component>())
+		{
+			stage._sweep.update(physic_component.id_data, physic_component.physic_data.position_data, physic_component.physic_data.size_data);
+		}
+		stage._movers.for_each([&stage](Id const& id, Physic const& physic, Celerity const&)
+		{
+			stage._sweep.update(id, physic.position_data, physic.size_data);
+		});
 
-				if (check_collision(target_physic.physic_data.position_data, target_physic.physic_data.size_data,
-					entity_p.physic_data.position_data, entity_p.physic_data.size_data))
+		stage._overlap_events.clear();
+		stage._sweep.sweep(stage._overlap_events);
+
+		// Interactions only destroy later : the overlaps do not change while read
+		for (auto const& overlap : stage._sweep.overlaps())
+		{
+			if (overlap.first == target || overlap.second == target)
+			{
+				const Id other{ overlap.first == target ? overlap.second : overlap.first };
+				if (find_physic(stage, other))
 				{
-					entities_interaction(stage, target, entity_p.id_data, entity_to_remove);
+					entities_interaction(stage, target, other);
 				}
 			}
 		}
-
-		remove_entities(stage, entity_to_remove);
-
 	}
 
 	void update_ai(Stage & stage, Ai_component const& target, A_star & path_finding, Id const& player)
 	{
 		if (target.ai_data.behavior == Behavior::aggressive)
 		{
-			Physic_component target_physic{ get_component(stage._physics, target.id_data) };
+			const Physic target_physic{ get_physic(stage, target.id_data) };
+
+			Position target_center{ get_center(target_physic.position_data, target_physic.size_data) };
+			Position player_position{ get_physic(stage, player).position_data };
 
-			Position target_center{ get_center(target_physic.physic_data.position_data, target_physic.physic_data.size_data) };
-			Position player_position{ get_component(stage._physics, player).physic_data.position_data };
+			Position next_position;
+			bool has_next{ false };
 
-			std::vector<Position> pos_path{ choose_path(path_finding, target_physic.physic_data.position_data, target_physic.physic_data.size_data, player_position) };
-			pos_path.pop_back();
+			Planner_component * planner{ stage._components.try_get<Planner_component>(target.id_data) };
+			Path_memory_component * memory{ stage._components.try_get<Path_memory_component>(target.id_data) };
+			Path_request_component * request{ stage._components.try_get<Path_request_component>(target.id_data) };
+			Sliced_path_component * sliced{ stage._components.try_get<Sliced_path_component>(target.id_data) };
+			Path_scratch_component * buffers{ stage._components.try_get<Path_scratch_component>(target.id_data) };
 
-			if (!pos_path.empty())
+			if (target.ai_data.pathing == Pathing::flow_field && path_finding.flow_field_targets(player_position.x, player_position.y))
+			{
+				has_next = choose_flow_step(path_finding, target_physic.position_data, target_physic.size_data, next_position);
+			}
+			else if (target.ai_data.pathing == Pathing::async && request != nullptr)
+			{
+				has_next = choose_async_step(*stage._path_service, request->path_request_data, target.id_data, target_physic.position_data, target_physic.size_data, player_position, path_finding.get_tile_size(), next_position);
+			}
+			else if (target.ai_data.pathing == Pathing::cooperative)
 			{
-				Position next_position{ pos_path.back() };
+				has_next = choose_cooperative_step(stage, path_finding, target.id_data, target_physic.position_data, target_physic.size_data, player_position, next_position);
+			}
+			else if (target.ai_data.pathing == Pathing::time_sliced && sliced != nullptr)
+			{
+				has_next = choose_sliced_step(sliced->sliced_path_data, target_physic.position_data, target_physic.size_data, path_finding.get_tile_size(), next_position);
+			}
+			else if (buffers != nullptr && (target.ai_data.pathing == Pathing::search || target.ai_data.pathing == Pathing::flow_field))
+			{
+				has_next = choose_buffered_step(path_finding, buffers->path_scratch_data.corners, target_physic.position_data, target_physic.size_data, player_position, next_position);
+			}
+			else
+			{
+				std::vector<Position> pos_path;
+				if (target.ai_data.pathing == Pathing::incremental && planner != nullptr)
+				{
+					pos_path = choose_planned_path(path_finding, planner->planner_data, target_physic.position_data, target_physic.size_data, player_position);
+				}
+				else if (target.ai_data.pathing == Pathing::cached && memory != nullptr)
+				{
+					pos_path = choose_cached_path(path_finding, memory->path_memory_data, target_physic.position_data, target_physic.size_data, player_position);
+				}
+				else
+				{
+					pos_path = choose_path(path_finding, target_physic.position_data, target_physic.size_data, player_position);
+				}
+				if (!pos_path.empty())
+				{
+					pos_path.pop_back();
+				}
 
-				Speed spd{ get_component(stage._speeds, target.id_data).speed_data };
+				has_next = !pos_path.empty();
+				if (has_next)
+				{
+					next_position = pos_path.back();
+				}
+			}
+
+			if (has_next)
+			{
+				Speed spd{ stage._components.get<Speed_component>(target.id_data).speed_data };
 
 				Celerity acceleration{ 0, 0 };
 
@@ -369,7 +784,25 @@ namespace ecs
 
 	void update_ais(Stage & stage, A_star & path_finding, Id const& player)
 	{
-		for (auto & entity : stage._ais)
+		if (stage._path_service)
+		{
+			stage._path_service->cancel_if([&stage](Id const& agent) { return !is_alive(stage, agent); });
+		}
+		stage._reservations.clear();
+
+		if (!stage._components.pool<Sliced_path_component>().empty())
+		{
+			Position player_position{ get_physic(stage, player).position_data };
+			schedule_sliced_searches(stage, path_finding, player_position, sliced_node_budget);
+		}
+
+		if (path_finding.flow_field_enabled())
+		{
+			Position player_position{ get_physic(stage, player).position_data };
+			path_finding.update_flow_field(player_position.x, player_position.y);
+		}
+
+		for (auto & entity : stage._components.pool<Ai_component>())
 		{
 			update_ai(stage, entity, path_finding, player);
 		}
@@ -377,10 +810,9 @@ namespace ecs
 
 	void update_animations(Stage & stage)
 	{
-		for (auto & animation_component : stage._animations)
+		stage._components.view<Animation_component, Sprite_component>().each([&stage](Id const& id, Animation_component & animation_component, Sprite_component & sprite_component)
 		{
-			const auto & size_component{ get_component(stage._physics, animation_component.id_data).physic_data.size_data };
-			auto & sprite_component{ get_component(stage._sprites, animation_component.id_data) };
+			const auto & size_component{ get_physic(stage, id).size_data };
 
 			sprite_component.sprite_data.setTextureRect(sf::IntRect{
 				animation_component.animation_data.step * size_component.width,
@@ -388,12 +820,12 @@ namespace ecs
 				size_component.width,
 				size_component.height
 				});
-		}
+		});
 	}
 
 	void update_animations_step(Stage & stage, long long delta_t)
 	{
-		for (auto & animation_component : stage._animations)
+		for (auto & animation_component : stage._components.pool<Animation_component>())
 		{
 			animation_component.animation_data.time_spended += delta_t;
 
@@ -413,40 +845,43 @@ namespace ecs
 
 	void update_sprites_position(Stage & stage)
 	{
-		for (auto & sprite : stage._sprites)
+		stage._components.view<Sprite_component, Physic_component>().each([](Id const&, Sprite_component & sprite, Physic_component & physic_component)
 		{
-			auto & physic_component{ get_component(stage._physics, sprite.id_data) };
-
 			sprite.sprite_data.setPosition(physic_component.physic_data.position_data.x, physic_component.physic_data.position_data.y);
-		}
+		});
+		stage._movers.for_each([&stage](Id const& id, Physic const& physic, Celerity const&)
+		{
+			stage._components.get<Sprite_component>(id).sprite_data.setPosition(physic.position_data.x, physic.position_data.y);
+		});
 	}
 
 	void update_view(sf::RenderWindow & window, Stage & stage, Id const& player)
 	{
-		auto player_physic{ get_component(stage._physics, player) };
+		const Physic player_physic{ get_physic(stage, player) };
 
 		float screen_width{ static_cast<float>(window.getSize().x) };
 		float screen_height{ static_cast<float>(window.getSize().y) };
 
-		Map_infos infos_map_loaded{ stage._map.get_loaded_infos() };
+		Collider_grid const& colliders{ stage._map.get_colliders() };
+		const Size tile_size{ stage._map.get_tile_size() };
 
-		float center_x{ player_physic.physic_data.position_data.x + player_physic.physic_data.size_data.width / 2 - screen_width / 2 };
+		float center_x{ player_physic.position_data.x + player_physic.size_data.width / 2 - screen_width / 2 };
 		if (center_x < 0)
 		{
 			center_x = 0;
 		}
-		else if (center_x + screen_width > infos_map_loaded.nb_cols * infos_map_loaded.tile_size.width)
+		else if (center_x + screen_width > colliders.nb_cols() * tile_size.width)
 		{
-			center_x = infos_map_loaded.nb_cols * infos_map_loaded.tile_size.width - screen_width;
+			center_x = colliders.nb_cols() * tile_size.width - screen_width;
 		}
-		float center_y{ player_physic.physic_data.position_data.y + player_physic.physic_data.size_data.height / 2 - screen_height / 2 };
+		float center_y{ player_physic.position_data.y + player_physic.size_data.height / 2 - screen_height / 2 };
 		if (center_y < 0)
 		{
 			center_y = 0;
 		}
-		else if (center_y + screen_height > infos_map_loaded.nb_rows * infos_map_loaded.tile_size.height)
+		else if (center_y + screen_height > colliders.nb_rows() * tile_size.height)
 		{
-			center_y = infos_map_loaded.nb_rows * infos_map_loaded.tile_size.height - screen_height;
+			center_y = colliders.nb_rows() * tile_size.height - screen_height;
 		}
 
 		window.setView(sf::View{ sf::FloatRect{ center_x, center_y,  screen_width, screen_height } });
@@ -455,18 +890,28 @@ namespace ecs
 	void udpate_systems(Stage & stage, Id const& player, A_star & a_star, sf::RenderWindow & window, long long  delta_t){
 		ecs::update_ais(stage, a_star, player);
 		ecs::update_positions(stage, delta_t);
-		ecs::update_collisions(stage, player);
+		if (stage._broadphase == ecs::Broadphase::sweep_and_prune)
+		{
+			ecs::update_collisions_sweep(stage, player);
+		}
+		else
+		{
+			ecs::update_mob_collisions(stage);
+			ecs::update_collisions(stage, player);
+		}
 
 		ecs::update_animations_step(stage, delta_t);
 		ecs::update_animations(stage);
 
 		ecs::update_sprites_position(stage);
 		ecs::update_view(window, stage, player);
+
+		ecs::flush_destroyed(stage);
 	}
 
 	void display_entities(Stage & stage, sf::RenderWindow & window)
 	{
-		for (auto & entity : stage._sprites)
+		for (auto & entity : stage._components.pool<Sprite_component>())
 		{
 			window.draw(entity.sprite_data);
 		}
@@ -504,7 +949,7 @@ Texture_pack create_texture_pack(Textures_infos const& infos)
 
 void keyboard_input(ecs::Stage & stage, ecs::Id target)
 {
-	ecs::Speed acceleration{ ecs::get_component(stage._speeds, target).speed_data };
+	ecs::Speed acceleration{ stage._components.get<ecs::Speed_component>(target).speed_data };
 
 	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Z) || sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
 	{
@@ -544,10 +989,45 @@ ecs::Id add_player(Mob_infos const& infos, Texture_pack const& textures, ecs::St
 	return id;
 }
 
-void add_ennemie(Mob_infos const& infos, sf::Texture const& texture, ecs::Stage & level)
+// Pathing named in the level, the flow field when none is given
+ecs::Pathing get_pathing(std::string const& name)
+{
+	if (name.empty() || name == "flow_field")
+	{
+		return ecs::Pathing::flow_field;
+	}
+	else if (name == "search")
+	{
+		return ecs::Pathing::search;
+	}
+	else if (name == "incremental")
+	{
+		return ecs::Pathing::incremental;
+	}
+	else if (name == "cached")
+	{
+		return ecs::Pathing::cached;
+	}
+	else if (name == "async")
+	{
+		return ecs::Pathing::async;
+	}
+	else if (name == "time_sliced")
+	{
+		return ecs::Pathing::time_sliced;
+	}
+	else if (name == "cooperative")
+	{
+		return ecs::Pathing::cooperative;
+	}
+
+	throw LoaderException{ "Unknown pathing '" + name + "'" };
+}
+
+void add_ennemie(Mob_infos const& infos, sf::Texture const& texture, ecs::Stage & level, A_star & path_finding)
 {
 	auto id{ ecs::add_mob(level, ecs::Physic{ infos.position, infos.size }, infos.speed, texture) };
-	ecs::add_ai(level, id, ecs::Behavior::aggressive);
+	ecs::add_ai(level, path_finding, id, ecs::Behavior::aggressive, get_pathing(infos.pathing));
 
 	if (infos.animation.nb_animation != 0)
 	{
@@ -559,11 +1039,11 @@ void add_ennemie(Mob_infos const& infos, sf::Texture const& texture, ecs::Stage
 
 }
 
-void add_ennemies(std::vector<Mob_infos> const& infos, Texture_pack const& textures, ecs::Stage & level)
+void add_ennemies(std::vector<Mob_infos> const& infos, Texture_pack const& textures, ecs::Stage & level, A_star & path_finding)
 {
 	for (size_t i{ 0 }; i < infos.size(); i++)
 	{
-		add_ennemie(infos[i], textures._ennemies[i], level);
+		add_ennemie(infos[i], textures._ennemies[i], level, path_finding);
 	}
 }
 
@@ -577,8 +1057,10 @@ void add_points(Points_infos const& infos, Texture_pack const& textures, ecs::St
 
 int main()
 {
+	const std::string level_path{ "level_1.xml" };
+
 	Loader loader{};
-	loader.load("level_1.xml");
+	loader.load(level_path);
 
 	Map_infos map_infos;
 	try
@@ -591,19 +1073,29 @@ int main()
 		return -1;
 	}
 
-	ecs::Stage level_1{ Map{ map_infos }};
+	ecs::Stage level_1{ Map{ map_infos }, Spatial_grid{ map_infos }, Tile_index{ map_infos } };
 	A_star a_star{ map_infos };
+	a_star.set_flow_field_enabled(true);
+	// Opt-in for small levels played without the flow field, cached next to the level
+	const bool use_distance_table{ false };
+	if (use_distance_table && !a_star.flow_field_enabled())
+	{
+		a_star.enable_distance_table(level_path + ".paths");
+	}
 
 	Texture_pack textures{ create_texture_pack( loader.get_textures_infos() ) };
 
 	auto player = add_player(loader.get_player_infos(), textures, level_1);
-	add_ennemies(loader.get_ennemies_infos(), textures, level_1);
+	add_ennemies(loader.get_ennemies_infos(), textures, level_1, a_star);
 	add_points( loader.get_points_infos(), textures, level_1 );
 
 	sf::RenderWindow window(sf::VideoMode{ 900 , 675, 32 }, "PacMan");
 	//window.setFramerateLimit(60);
 
 	auto start{ std::chrono::system_clock::now() };
+	// Hits and misses of the path caches logged every few seconds
+	const long long cache_log_period{ 5000 };
+	long long cache_log_elapsed{ 0 };
 
 	while (window.isOpen())
 	{
@@ -621,6 +1113,20 @@ int main()
 		auto delta_t{ std::chrono::duration_cast<std::chrono::milliseconds>(current_time.time_since_epoch()).count() - std::chrono::duration_cast<std::chrono::milliseconds>(start.time_since_epoch()).count() };
 		ecs::udpate_systems(level_1, player, a_star, window, delta_t);
 
+		cache_log_elapsed += delta_t;
+		if (cache_log_elapsed >= cache_log_period)
+		{
+			cache_log_elapsed = 0;
+
+			size_t hits;
+			size_t misses;
+			ecs::path_cache_stats(level_1, hits, misses);
+			if (hits + misses != 0)
+			{
+				std::cout << "Path cache : " << hits << " hits, " << misses << " misses" << std::endl;
+			}
+		}
+
 		window.clear();
 
 		level_1._map.draw_map(window);
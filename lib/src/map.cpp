@@ -3,12 +3,15 @@
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 
 Map::Map(Map_infos const& infos) :
 	m_infos{ infos },
-	m_tileset{load_tileset(infos.tileset_path)}
+	m_tileset{load_tileset(infos.tileset_path)},
+	m_colliders{ infos.nb_cols, infos.nb_rows, infos.collider_map }
 {
+	m_infos.collider_map = std::vector<bool>{};
 	create_map();
 }
 
@@ -57,27 +60,133 @@ void Map::draw_map(sf::RenderWindow & render_window)
 
 bool Map::check_collision(float x, float y, int w, int h)
 {
-	float x1_map{ std::floor (x / m_infos.tile_size.width) };
-	float y1_map{ std::floor (y / m_infos.tile_size.height) };
-	float x2_map{ std::floor((x + w) / m_infos.tile_size.width) };
-	float y2_map{ std::floor((y + h) / m_infos.tile_size.height) };
-
-	float tile1{ y1_map * m_infos.nb_cols + x1_map };
-	float tile2{ y1_map * m_infos.nb_cols + x2_map };
-	float tile3{ y2_map * m_infos.nb_cols + x1_map };
-	float tile4{ y2_map * m_infos.nb_cols + x2_map };
-
-	if (m_infos.collider_map[tile1]) { return true; }
-	if (m_infos.collider_map[tile2]) { return true; }
-	if (m_infos.collider_map[tile3]) { return true; }
-	if (m_infos.collider_map[tile4]) { return true; }
-
-	return false;
+	const int x1_map{ static_cast<int>(std::floor(x / m_infos.tile_size.width)) };
+	const int y1_map{ static_cast<int>(std::floor(y / m_infos.tile_size.height)) };
+	const int x2_map{ static_cast<int>(std::floor((x + w) / m_infos.tile_size.width)) };
+	const int y2_map{ static_cast<int>(std::floor((y + h) / m_infos.tile_size.height)) };
+
+	// Every tile under the box, not only the corners ; outside the map is a wall
+	return m_colliders.any_wall(x1_map, y1_map, x2_map, y2_map);
+}
+
+// Same tiles as check_collision : the box covers [x, x + w] and [y, y + h]
+Sweep_result Map::sweep(Position const& position, Size const& size, float dx, float dy) const
+{
+	Sweep_result result;
+
+	result.position.x = sweep_x(position.x, position.y, size, dx, result.normal_x);
+	result.position.y = sweep_y(result.position.x, position.y, size, dy, result.normal_y);
+
+	return result;
+}
+
+float Map::sweep_x(float x, float y, Size const& size, float dx, int & normal) const
+{
+	const float target{ x + dx };
+	const int y1_map{ tile_y(y) };
+	const int y2_map{ tile_y(y + size.height) };
+
+	if (dx > 0)
+	{
+		// Columns entered by the right side, the first wall stops it just before
+		const int last{ tile_x(target + size.width) };
+		for (int column{ tile_x(x + size.width) + 1 }; column <= last; column++)
+		{
+			if (m_colliders.any_wall(column, y1_map, column, y2_map))
+			{
+				normal = -1;
+
+				float stop{ static_cast<float>(column * m_infos.tile_size.width - size.width) };
+				while (stop > x && tile_x(stop + size.width) >= column)
+				{
+					stop = std::nextafter(stop, x);
+				}
+				return std::max(stop, x);
+			}
+		}
+	}
+	else if (dx < 0)
+	{
+		const int last{ tile_x(target) };
+		for (int column{ tile_x(x) - 1 }; column >= last; column--)
+		{
+			if (m_colliders.any_wall(column, y1_map, column, y2_map))
+			{
+				normal = 1;
+				return std::min(static_cast<float>((column + 1) * m_infos.tile_size.width), x);
+			}
+		}
+	}
+
+	return target;
+}
+
+float Map::sweep_y(float x, float y, Size const& size, float dy, int & normal) const
+{
+	const float target{ y + dy };
+	const int x1_map{ tile_x(x) };
+	const int x2_map{ tile_x(x + size.width) };
+
+	if (dy > 0)
+	{
+		const int last{ tile_y(target + size.height) };
+		for (int row{ tile_y(y + size.height) + 1 }; row <= last; row++)
+		{
+			if (m_colliders.any_wall(x1_map, row, x2_map, row))
+			{
+				normal = -1;
+
+				float stop{ static_cast<float>(row * m_infos.tile_size.height - size.height) };
+				while (stop > y && tile_y(stop + size.height) >= row)
+				{
+					stop = std::nextafter(stop, y);
+				}
+				return std::max(stop, y);
+			}
+		}
+	}
+	else if (dy < 0)
+	{
+		const int last{ tile_y(target) };
+		for (int row{ tile_y(y) - 1 }; row >= last; row--)
+		{
+			if (m_colliders.any_wall(x1_map, row, x2_map, row))
+			{
+				normal = 1;
+				return std::min(static_cast<float>((row + 1) * m_infos.tile_size.height), y);
+			}
+		}
+	}
+
+	return target;
+}
+
+int Map::tile_x(float x) const
+{
+	return static_cast<int>(std::floor(x / m_infos.tile_size.width));
+}
+
+int Map::tile_y(float y) const
+{
+	return static_cast<int>(std::floor(y / m_infos.tile_size.height));
 }
 
 Map_infos Map::get_loaded_infos() const
 {
-	return m_infos;
+	Map_infos infos{ m_infos };
+	infos.collider_map = m_colliders.to_wall_map();
+
+	return infos;
+}
+
+Collider_grid const& Map::get_colliders() const
+{
+	return m_colliders;
+}
+
+Size Map::get_tile_size() const
+{
+	return m_infos.tile_size;
 }
 
 
@@ -0,0 +1,37 @@
+#include "path_buffer.h"
+
+Path_buffer::Path_buffer()
+{
+}
+
+Path_buffer::Path_buffer(size_t capacity) :
+	m_positions(capacity)
+{
+}
+
+void Path_buffer::reserve(size_t capacity)
+{
+	if (capacity > m_positions.size())
+	{
+		m_positions.resize(capacity);
+	}
+}
+
+size_t Path_buffer::capacity() const
+{
+	return m_positions.size();
+}
+
+Position * Path_buffer::data()
+{
+	return m_positions.data();
+}
+
+Position const& Path_buffer::operator[](size_t index) const
+{
+	return m_positions[index];
+}
+
+Path_buffer::~Path_buffer()
+{
+}
@@ -0,0 +1,65 @@
+#include "path_cache.h"
+
+#include <algorithm>
+
+Path_cache::Path_cache()
+{
+}
+
+bool Path_cache::advance(int start_cell, int goal_cell, size_t collider_revision)
+{
+	if (goal_cell != m_goal_cell || collider_revision != m_collider_revision)
+	{
+		return false;
+	}
+
+	auto it{ std::find(m_cells.begin(), m_cells.end(), start_cell) };
+	if (it == m_cells.end())
+	{
+		return false;
+	}
+
+	// A suffix of a shortest path is still a shortest path
+	const auto keep{ it - m_cells.begin() + 1 };
+	m_cells.resize(keep);
+	m_path.resize(keep);
+
+	m_hits++;
+	return true;
+}
+
+void Path_cache::store(std::vector<Position> const& path, std::vector<int> const& cells, int goal_cell, size_t collider_revision)
+{
+	m_path = path;
+	m_cells = cells;
+	m_goal_cell = goal_cell;
+	m_collider_revision = collider_revision;
+
+	m_misses++;
+}
+
+std::vector<Position> const& Path_cache::path() const
+{
+	return m_path;
+}
+
+size_t Path_cache::hits() const
+{
+	return m_hits;
+}
+
+size_t Path_cache::misses() const
+{
+	return m_misses;
+}
+
+void Path_cache::clear()
+{
+	m_path.clear();
+	m_cells.clear();
+	m_goal_cell = -1;
+}
+
+Path_cache::~Path_cache()
+{
+}
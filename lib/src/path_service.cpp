@@ -0,0 +1,174 @@
+#include "path_service.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "grid_search.h"
+
+Path_service::Path_service(Map_infos const& infos, size_t nb_workers)
+	: m_tile_size{ infos.tile_size },
+	m_snapshot{ std::make_shared<const Snapshot>(Snapshot{ infos.tile_size, Collider_grid{ infos.nb_cols, infos.nb_rows, infos.collider_map } }) }
+{
+	for (size_t i{ 0 }; i < std::max<size_t>(1, nb_workers); i++)
+	{
+		m_workers.emplace_back(&Path_service::work, this);
+	}
+}
+
+void Path_service::set_collider(Index const& index, bool wall)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	Collider_grid const& colliders{ m_snapshot->colliders };
+	if (index.x < 0 || index.y < 0 || index.x >= colliders.nb_cols() || index.y >= colliders.nb_rows() || colliders.is_wall(index.x, index.y) == wall)
+	{
+		return;
+	}
+
+	auto snapshot{ std::make_shared<Snapshot>(*m_snapshot) };
+	snapshot->colliders.set_wall(index.x, index.y, wall);
+	m_snapshot = snapshot;
+}
+
+Path_service::Ticket Path_service::submit(ecs::Id const& agent, Position const& start, Position const& goal)
+{
+	Ticket ticket;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		ticket = m_next_ticket++;
+		m_requests.push_back(Request{ ticket, agent, start, goal, m_snapshot });
+		m_results.emplace(ticket, Result{ agent, false, {} });
+	}
+	m_wake.notify_one();
+
+	return ticket;
+}
+
+bool Path_service::poll(Ticket const& ticket, std::vector<Position> & path)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it{ m_results.find(ticket) };
+	if (it == m_results.end() || !it->second.done)
+	{
+		return false;
+	}
+
+	path = std::move(it->second.path);
+	m_results.erase(it);
+
+	return true;
+}
+
+void Path_service::cancel_if(std::function<bool(ecs::Id const&)> const& predicate)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(), [&predicate](Request const& request)
+	{
+		return predicate(request.agent);
+	}), m_requests.end());
+
+	// A running request finds its result gone and drops its path
+	for (auto it{ m_results.begin() }; it != m_results.end(); )
+	{
+		it = predicate(it->second.agent) ? m_results.erase(it) : std::next(it);
+	}
+}
+
+size_t Path_service::pending() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return static_cast<size_t>(std::count_if(m_results.begin(), m_results.end(), [](auto const& result)
+	{
+		return !result.second.done;
+	}));
+}
+
+Index Path_service::tile_of(Position const& position) const
+{
+	return Index{ static_cast<int>(std::floor(position.x / m_tile_size.width)), static_cast<int>(std::floor(position.y / m_tile_size.height)) };
+}
+
+void Path_service::work()
+{
+	Search_space search_space;
+
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_wake.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+
+			if (m_stopping)
+			{
+				return;
+			}
+
+			request = std::move(m_requests.front());
+			m_requests.pop_front();
+		}
+
+		std::vector<Position> path{ search(*request.snapshot, search_space, request.start, request.goal) };
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		auto it{ m_results.find(request.ticket) };
+		if (it != m_results.end())
+		{
+			it->second.path = std::move(path);
+			it->second.done = true;
+		}
+	}
+}
+
+// Same search as A_star::create_center_path, on the snapshot
+std::vector<Position> Path_service::search(Snapshot const& snapshot, Search_space & search_space, Position const& start, Position const& goal)
+{
+	Collider_grid const& colliders{ snapshot.colliders };
+	const int nb_cols{ colliders.nb_cols() };
+	const Size tile_size{ snapshot.tile_size };
+
+	auto to_index{ [&tile_size](Position const& position)
+	{
+		return Index{ static_cast<int>(std::floor(position.x / tile_size.width)), static_cast<int>(std::floor(position.y / tile_size.height)) };
+	} };
+	auto is_inside{ [&colliders](Index const& index)
+	{
+		return index.x >= 0 && index.y >= 0 && index.x < colliders.nb_cols() && index.y < colliders.nb_rows();
+	} };
+
+	const Index b_index{ to_index(start) };
+	const Index e_index{ to_index(goal) };
+
+	if (!is_inside(b_index) || !is_inside(e_index) || !find_grid_path(search_space, colliders, b_index, e_index))
+	{
+		return {};
+	}
+
+	std::vector<Position> path;
+	for (int cell{ e_index.y * nb_cols + e_index.x }; cell != -1; cell = search_space.node(cell).parent)
+	{
+		const Position corner{ static_cast<float>((cell % nb_cols) * tile_size.width), static_cast<float>((cell / nb_cols) * tile_size.height) };
+		path.push_back(get_center(corner, tile_size));
+	}
+
+	return path;
+}
+
+Path_service::~Path_service()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+
+	for (auto & worker : m_workers)
+	{
+		worker.join();
+	}
+}
@@ -0,0 +1,101 @@
+#include "reservation_table.h"
+
+Reservation_table::Reservation_table()
+{
+}
+
+void Reservation_table::resize(size_t nb_cells, int nb_steps)
+{
+	m_nb_cells = nb_cells;
+	m_nb_steps = nb_steps;
+	m_slots.assign(nb_cells * static_cast<size_t>(nb_steps), Slot{});
+	m_generation = 1;
+	m_size = 0;
+}
+
+size_t Reservation_table::nb_cells() const
+{
+	return m_nb_cells;
+}
+
+int Reservation_table::nb_steps() const
+{
+	return m_nb_steps;
+}
+
+void Reservation_table::clear()
+{
+	m_generation++;
+	m_size = 0;
+
+	if (m_generation == 0) // Wrapped : old stamps could match again
+	{
+		m_slots.assign(m_slots.size(), Slot{});
+		m_generation = 1;
+	}
+}
+
+bool Reservation_table::is_inside(int cell, int step) const
+{
+	return cell >= 0 && step >= 0 && static_cast<size_t>(cell) < m_nb_cells && step < m_nb_steps;
+}
+
+ecs::Id Reservation_table::owner(int cell, int step) const
+{
+	if (!is_inside(cell, step))
+	{
+		return ecs::null_entity;
+	}
+
+	Slot const& slot{ m_slots[step * m_nb_cells + cell] };
+
+	return slot.stamp == m_generation ? slot.owner : ecs::null_entity;
+}
+
+bool Reservation_table::reserve(int cell, int step, ecs::Id const& agent)
+{
+	if (!is_inside(cell, step))
+	{
+		return false;
+	}
+
+	Slot & slot{ m_slots[step * m_nb_cells + cell] };
+	if (slot.stamp == m_generation)
+	{
+		return slot.owner == agent;
+	}
+
+	slot.stamp = m_generation;
+	slot.owner = agent;
+	m_size++;
+
+	return true;
+}
+
+bool Reservation_table::is_free(int cell, int step, ecs::Id const& agent) const
+{
+	const ecs::Id holder{ owner(cell, step) };
+
+	return holder == ecs::null_entity || holder == agent;
+}
+
+bool Reservation_table::crosses(int from, int to, int step, ecs::Id const& agent) const
+{
+	if (step == 0)
+	{
+		return false;
+	}
+
+	const ecs::Id holder{ owner(from, step) };
+
+	return holder != ecs::null_entity && holder != agent && owner(to, step - 1) == holder;
+}
+
+size_t Reservation_table::size() const
+{
+	return m_size;
+}
+
+Reservation_table::~Reservation_table()
+{
+}
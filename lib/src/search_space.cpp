@@ -0,0 +1,167 @@
+#include "search_space.h"
+
+void Search_space::resize(size_t nb_nodes)
+{
+	m_nodes.assign(nb_nodes, Search_node{});
+	m_heap.clear();
+	m_heap.reserve(nb_nodes);
+	m_generation = 0;
+}
+
+size_t Search_space::size() const
+{
+	return m_nodes.size();
+}
+
+void Search_space::begin_search()
+{
+	m_heap.clear();
+	m_generation++;
+
+	if (m_generation == 0) // Wrapped : old stamps could match again
+	{
+		for (auto & node : m_nodes) { node.stamp = 0; }
+		m_generation = 1;
+	}
+}
+
+bool Search_space::visited(int node) const
+{
+	return m_nodes[node].stamp == m_generation;
+}
+
+bool Search_space::is_open(int node) const
+{
+	return visited(node) && m_nodes[node].heap_index != closed;
+}
+
+bool Search_space::is_closed(int node) const
+{
+	return visited(node) && m_nodes[node].heap_index == closed;
+}
+
+Search_node & Search_space::node(int node)
+{
+	return m_nodes[node];
+}
+
+Search_node const& Search_space::node(int node) const
+{
+	return m_nodes[node];
+}
+
+bool Search_space::open(int node, int g, int f, int parent)
+{
+	Search_node & state{ m_nodes[node] };
+
+	if (!visited(node))
+	{
+		state = Search_node{ m_generation, g, f, parent, static_cast<int>(m_heap.size()) };
+		m_heap.push_back(node);
+		sift_up(m_heap.size() - 1);
+
+		return true;
+	}
+
+	if (state.heap_index == closed || g >= state.g)
+	{
+		return false;
+	}
+
+	state.f -= state.g - g;
+	state.g = g;
+	state.parent = parent;
+	sift_up(static_cast<size_t>(state.heap_index));
+
+	return true;
+}
+
+int Search_space::pop()
+{
+	const int result{ m_heap.front() };
+	const int last{ m_heap.back() };
+	m_heap.pop_back();
+
+	if (!m_heap.empty())
+	{
+		place(0, last);
+		sift_down(0);
+	}
+
+	m_nodes[result].heap_index = closed;
+
+	return result;
+}
+
+int Search_space::top() const
+{
+	return m_heap.front();
+}
+
+bool Search_space::empty() const
+{
+	return m_heap.empty();
+}
+
+bool Search_space::before(int node_1, int node_2) const
+{
+	Search_node const& state_1{ m_nodes[node_1] };
+	Search_node const& state_2{ m_nodes[node_2] };
+
+	return state_1.f < state_2.f || (state_1.f == state_2.f && state_1.g > state_2.g);
+}
+
+void Search_space::place(size_t heap_index, int node)
+{
+	m_heap[heap_index] = node;
+	m_nodes[node].heap_index = static_cast<int>(heap_index);
+}
+
+void Search_space::sift_up(size_t heap_index)
+{
+	const int node{ m_heap[heap_index] };
+
+	while (heap_index > 0)
+	{
+		const size_t parent{ (heap_index - 1) / 2 };
+		if (!before(node, m_heap[parent]))
+		{
+			break;
+		}
+
+		place(heap_index, m_heap[parent]);
+		heap_index = parent;
+	}
+
+	place(heap_index, node);
+}
+
+void Search_space::sift_down(size_t heap_index)
+{
+	const int node{ m_heap[heap_index] };
+	const size_t size{ m_heap.size() };
+
+	while (true)
+	{
+		size_t child{ heap_index * 2 + 1 };
+		if (child >= size)
+		{
+			break;
+		}
+
+		if (child + 1 < size && before(m_heap[child + 1], m_heap[child]))
+		{
+			child++;
+		}
+
+		if (!before(m_heap[child], node))
+		{
+			break;
+		}
+
+		place(heap_index, m_heap[child]);
+		heap_index = child;
+	}
+
+	place(heap_index, node);
+}
@@ -0,0 +1,80 @@
+#include "sliced_search.h"
+
+#include "grid_search.h"
+
+Sliced_search::Sliced_search()
+{
+}
+
+void Sliced_search::start(Collider_grid const* colliders, size_t revision, Index const& start, Index const& goal)
+{
+	m_colliders = colliders;
+	m_revision = revision;
+	m_goal = goal;
+	m_goal_cell = goal.y * colliders->nb_cols() + goal.x;
+
+	start_grid_search(m_search, *colliders, start, goal);
+
+	m_state = State::running;
+}
+
+int Sliced_search::step(int budget)
+{
+	if (m_state != State::running)
+	{
+		return 0;
+	}
+
+	int left{ budget };
+	const Grid_search_state state{ expand_grid_search(m_search, *m_colliders, m_goal, left) };
+
+	if (state == Grid_search_state::found)
+	{
+		m_state = State::found;
+	}
+	else if (state == Grid_search_state::failed)
+	{
+		m_state = State::failed;
+	}
+
+	return budget - left;
+}
+
+void Sliced_search::cancel()
+{
+	m_state = State::idle;
+}
+
+Sliced_search::State Sliced_search::state() const
+{
+	return m_state;
+}
+
+bool Sliced_search::is_running() const
+{
+	return m_state == State::running;
+}
+
+size_t Sliced_search::revision() const
+{
+	return m_revision;
+}
+
+bool Sliced_search::extract_path(std::vector<int> & cells) const
+{
+	if (m_state != State::found)
+	{
+		return false;
+	}
+
+	for (int cell{ m_goal_cell }; cell != -1; cell = m_search.node(cell).parent)
+	{
+		cells.push_back(cell);
+	}
+
+	return true;
+}
+
+Sliced_search::~Sliced_search()
+{
+}
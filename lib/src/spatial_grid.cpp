@@ -0,0 +1,196 @@
+#include "spatial_grid.h"
+
+#include <cmath>
+#include <algorithm>
+
+Spatial_grid::Spatial_grid(Map_infos const& infos) :
+	m_nb_rows{ infos.nb_rows },
+	m_nb_cols{ infos.nb_cols },
+	m_cell_size{ infos.tile_size },
+	m_cells(static_cast<size_t>(infos.nb_rows) * infos.nb_cols)
+{
+}
+
+Spatial_grid::Cell_range Spatial_grid::get_cell_range(Position const& pos, Size const& size) const
+{
+	Cell_range range{
+		static_cast<int>(std::floor(pos.x / m_cell_size.width)),
+		static_cast<int>(std::floor(pos.y / m_cell_size.height)),
+		static_cast<int>(std::floor((pos.x + size.width) / m_cell_size.width)),
+		static_cast<int>(std::floor((pos.y + size.height) / m_cell_size.height))
+	};
+
+	range.x1 = std::clamp(range.x1, 0, m_nb_cols - 1);
+	range.y1 = std::clamp(range.y1, 0, m_nb_rows - 1);
+	range.x2 = std::clamp(range.x2, 0, m_nb_cols - 1);
+	range.y2 = std::clamp(range.y2, 0, m_nb_rows - 1);
+
+	return range;
+}
+
+Spatial_grid::Record * Spatial_grid::find_record(ecs::Id const& id)
+{
+	const size_t index{ ecs::entity_index(id) };
+	if (index >= m_records.size() || m_records[index].id != id)
+	{
+		return nullptr;
+	}
+
+	return &m_records[index];
+}
+
+void Spatial_grid::link(ecs::Id const& id, Cell_range const& range)
+{
+	for (int y{ range.y1 }; y <= range.y2; y++)
+	{
+		for (int x{ range.x1 }; x <= range.x2; x++)
+		{
+			m_cells[y * m_nb_cols + x].push_back(id);
+		}
+	}
+}
+
+void Spatial_grid::unlink(ecs::Id const& id, Cell_range const& range)
+{
+	for (int y{ range.y1 }; y <= range.y2; y++)
+	{
+		for (int x{ range.x1 }; x <= range.x2; x++)
+		{
+			auto & cell{ m_cells[y * m_nb_cols + x] };
+			auto it{ std::find(cell.begin(), cell.end(), id) };
+			if (it != cell.end())
+			{
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+void Spatial_grid::insert(ecs::Id const& id, Position const& pos, Size const& size)
+{
+	const size_t index{ ecs::entity_index(id) };
+	if (index >= m_records.size())
+	{
+		m_records.resize(index + 1);
+	}
+
+	Record & record{ m_records[index] };
+	if (record.id != ecs::null_entity)
+	{
+		unlink(record.id, record.range);
+	}
+
+	record.id = id;
+	record.range = get_cell_range(pos, size);
+	record.stamp = 0;
+
+	link(id, record.range);
+}
+
+void Spatial_grid::update(ecs::Id const& id, Position const& pos, Size const& size)
+{
+	Record * record{ find_record(id) };
+	if (!record)
+	{
+		insert(id, pos, size);
+		return;
+	}
+
+	const Cell_range range{ get_cell_range(pos, size) };
+	if (range.x1 == record->range.x1 && range.y1 == record->range.y1 &&
+		range.x2 == record->range.x2 && range.y2 == record->range.y2)
+	{
+		return;
+	}
+
+	unlink(id, record->range);
+	record->range = range;
+	link(id, range);
+}
+
+bool Spatial_grid::remove(ecs::Id const& id)
+{
+	Record * record{ find_record(id) };
+	if (!record)
+	{
+		return false;
+	}
+
+	unlink(id, record->range);
+	record->id = ecs::null_entity;
+
+	return true;
+}
+
+bool Spatial_grid::contains(ecs::Id const& id) const
+{
+	const size_t index{ ecs::entity_index(id) };
+	return index < m_records.size() && m_records[index].id == id;
+}
+
+void Spatial_grid::query(Position const& pos, Size const& size, std::vector<ecs::Id> & result)
+{
+	m_query_stamp++;
+	if (m_query_stamp == 0) // Wrapped : old stamps could match again
+	{
+		for (auto & record : m_records) { record.stamp = 0; }
+		m_query_stamp = 1;
+	}
+
+	const Cell_range range{ get_cell_range(pos, size) };
+
+	for (int y{ range.y1 }; y <= range.y2; y++)
+	{
+		for (int x{ range.x1 }; x <= range.x2; x++)
+		{
+			for (auto const& id : m_cells[y * m_nb_cols + x])
+			{
+				Record & record{ m_records[ecs::entity_index(id)] };
+				if (record.stamp != m_query_stamp)
+				{
+					record.stamp = m_query_stamp;
+					result.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+void Spatial_grid::find_pairs(std::vector<std::pair<ecs::Id, ecs::Id>> & result) const
+{
+	for (int y{ 0 }; y < m_nb_rows; y++)
+	{
+		for (int x{ 0 }; x < m_nb_cols; x++)
+		{
+			auto const& cell{ m_cells[y * m_nb_cols + x] };
+
+			for (size_t i{ 0 }; i < cell.size(); i++)
+			{
+				Cell_range const& range_1{ m_records[ecs::entity_index(cell[i])].range };
+
+				for (size_t j{ i + 1 }; j < cell.size(); j++)
+				{
+					Cell_range const& range_2{ m_records[ecs::entity_index(cell[j])].range };
+
+					// Report the pair only in the first cell both entities share
+					if (std::max(range_1.x1, range_2.x1) == x && std::max(range_1.y1, range_2.y1) == y)
+					{
+						result.emplace_back(cell[i], cell[j]);
+					}
+				}
+			}
+		}
+	}
+}
+
+void Spatial_grid::clear()
+{
+	for (auto & cell : m_cells) { cell.clear(); }
+	m_records.clear();
+	m_query_stamp = 0;
+}
+
+Spatial_grid::~Spatial_grid()
+{
+}
@@ -0,0 +1,247 @@
+#include "sweep_and_prune.h"
+
+Sweep_and_prune::Sweep_and_prune()
+{
+}
+
+// Ties put a max before a min : boxes whose edges touch do not overlap
+bool Sweep_and_prune::before(Endpoint const& a, Endpoint const& b)
+{
+	return a.value < b.value || (a.value == b.value && a.is_max && !b.is_max);
+}
+
+std::uint64_t Sweep_and_prune::pair_key(std::uint32_t index_1, std::uint32_t index_2)
+{
+	if (index_1 > index_2)
+	{
+		std::swap(index_1, index_2);
+	}
+
+	return (static_cast<std::uint64_t>(index_1) << 32) | index_2;
+}
+
+Sweep_and_prune::Record * Sweep_and_prune::find_record(ecs::Id const& id)
+{
+	const size_t index{ ecs::entity_index(id) };
+	if (index >= m_records.size() || m_records[index].id != id)
+	{
+		return nullptr;
+	}
+
+	return &m_records[index];
+}
+
+void Sweep_and_prune::set_endpoint(int axis, size_t place, Endpoint const& endpoint)
+{
+	m_axes[axis][place] = endpoint;
+	m_records[endpoint.index].endpoints[axis][endpoint.is_max] = place;
+}
+
+void Sweep_and_prune::update(ecs::Id const& id, Position const& pos, Size const& size)
+{
+	const float mins[2]{ pos.x, pos.y };
+	const float maxs[2]{ pos.x + size.width, size.height + pos.y };
+
+	if (Record * record{ find_record(id) })
+	{
+		for (int axis{ 0 }; axis < 2; axis++)
+		{
+			m_axes[axis][record->endpoints[axis][0]].value = mins[axis];
+			m_axes[axis][record->endpoints[axis][1]].value = maxs[axis];
+		}
+		return;
+	}
+
+	const std::uint32_t index{ ecs::entity_index(id) };
+	if (index >= m_records.size())
+	{
+		m_records.resize(index + 1);
+	}
+	m_records[index].id = id;
+
+	// Added after every other endpoint : the box starts overlapping nothing and
+	// the sort moves it to its place like any other box
+	for (int axis{ 0 }; axis < 2; axis++)
+	{
+		auto & endpoints{ m_axes[axis] };
+
+		endpoints.push_back(Endpoint{});
+		set_endpoint(axis, endpoints.size() - 1, Endpoint{ mins[axis], index, false });
+		endpoints.push_back(Endpoint{});
+		set_endpoint(axis, endpoints.size() - 1, Endpoint{ maxs[axis], index, true });
+	}
+
+	m_size++;
+}
+
+bool Sweep_and_prune::remove(ecs::Id const& id)
+{
+	Record * record{ find_record(id) };
+	if (!record)
+	{
+		return false;
+	}
+
+	// Moved past every other endpoint, ending its overlaps on the way
+	for (int axis{ 0 }; axis < 2; axis++)
+	{
+		for (int is_max{ 1 }; is_max >= 0; is_max--)
+		{
+			for (size_t place{ record->endpoints[axis][is_max] }; place + 1 < m_axes[axis].size(); place++)
+			{
+				swap_down(axis, place + 1);
+			}
+		}
+
+		m_axes[axis].pop_back();
+		m_axes[axis].pop_back();
+	}
+
+	report(m_pending);
+
+	record->id = ecs::null_entity;
+	m_size--;
+
+	return true;
+}
+
+bool Sweep_and_prune::contains(ecs::Id const& id) const
+{
+	const size_t index{ ecs::entity_index(id) };
+	return index < m_records.size() && m_records[index].id == id;
+}
+
+void Sweep_and_prune::sweep(std::vector<Overlap_event> & events)
+{
+	events.insert(events.end(), m_pending.begin(), m_pending.end());
+	m_pending.clear();
+
+	sort_axis(0);
+	sort_axis(1);
+
+	report(events);
+}
+
+std::vector<std::pair<ecs::Id, ecs::Id>> const& Sweep_and_prune::overlaps() const
+{
+	return m_overlaps;
+}
+
+// Insertion sort : almost no swap when the order barely changed
+void Sweep_and_prune::sort_axis(int axis)
+{
+	auto & endpoints{ m_axes[axis] };
+
+	for (size_t i{ 1 }; i < endpoints.size(); i++)
+	{
+		for (size_t place{ i }; place > 0 && before(endpoints[place], endpoints[place - 1]); place--)
+		{
+			swap_down(axis, place);
+		}
+	}
+}
+
+void Sweep_and_prune::swap_down(int axis, size_t place)
+{
+	const Endpoint moving{ m_axes[axis][place] };
+	const Endpoint passed{ m_axes[axis][place - 1] };
+
+	if (moving.index != passed.index)
+	{
+		// A min passing a max : the boxes now overlap on this axis ; a max passing a min : no more
+		if (!moving.is_max && passed.is_max)
+		{
+			change_axes(moving.index, passed.index, 1);
+		}
+		else if (moving.is_max && !passed.is_max)
+		{
+			change_axes(moving.index, passed.index, -1);
+		}
+	}
+
+	set_endpoint(axis, place - 1, moving);
+	set_endpoint(axis, place, passed);
+}
+
+void Sweep_and_prune::change_axes(std::uint32_t index_1, std::uint32_t index_2, int delta)
+{
+	const std::uint64_t key{ pair_key(index_1, index_2) };
+	Pair_state & state{ m_pairs[key] };
+
+	const bool was_overlapping{ state.axes == 2 };
+	state.axes += delta;
+
+	// Only the state at the end of the sweep counts, a pair going back and
+	// forth during the sort reports nothing
+	if (was_overlapping != (state.axes == 2) && !state.changed)
+	{
+		state.changed = true;
+		m_changed.push_back(key);
+	}
+	else if (state.axes == 0 && !state.changed && !state.reported)
+	{
+		m_pairs.erase(key);
+	}
+}
+
+void Sweep_and_prune::report(std::vector<Overlap_event> & events)
+{
+	for (auto const& key : m_changed)
+	{
+		auto it{ m_pairs.find(key) };
+		Pair_state & state{ it->second };
+		state.changed = false;
+
+		const bool overlapping{ state.axes == 2 };
+		if (overlapping != state.reported)
+		{
+			const ecs::Id first{ m_records[static_cast<std::uint32_t>(key >> 32)].id };
+			const ecs::Id second{ m_records[static_cast<std::uint32_t>(key & 0xFFFFFFFFu)].id };
+			events.push_back(Overlap_event{ first, second, overlapping });
+
+			if (overlapping)
+			{
+				state.overlap = m_overlaps.size();
+				m_overlaps.emplace_back(first, second);
+			}
+			else
+			{
+				// Swap and pop, the moved pair learns its new place
+				auto const& last{ m_overlaps.back() };
+				m_pairs[pair_key(ecs::entity_index(last.first), ecs::entity_index(last.second))].overlap = state.overlap;
+				m_overlaps[state.overlap] = last;
+				m_overlaps.pop_back();
+			}
+
+			state.reported = overlapping;
+		}
+
+		if (state.axes == 0 && !state.reported)
+		{
+			m_pairs.erase(it);
+		}
+	}
+
+	m_changed.clear();
+}
+
+size_t Sweep_and_prune::size() const
+{
+	return m_size;
+}
+
+void Sweep_and_prune::clear()
+{
+	m_axes[0].clear();
+	m_axes[1].clear();
+	m_records.clear();
+	m_pairs.clear();
+	m_changed.clear();
+	m_overlaps.clear();
+	m_pending.clear();
+	m_size = 0;
+}
+
+Sweep_and_prune::~Sweep_and_prune()
+{
+}
@@ -0,0 +1,102 @@
+#include "tile_index.h"
+
+#include <cmath>
+#include <algorithm>
+
+Tile_index::Tile_index(Map_infos const& infos) :
+	m_nb_rows{ infos.nb_rows },
+	m_nb_cols{ infos.nb_cols },
+	m_tile_size{ infos.tile_size },
+	m_tiles(static_cast<size_t>(infos.nb_rows) * infos.nb_cols)
+{
+}
+
+int Tile_index::get_tile(float x, float y) const
+{
+	const int tile_x{ std::clamp(static_cast<int>(std::floor(x / m_tile_size.width)), 0, m_nb_cols - 1) };
+	const int tile_y{ std::clamp(static_cast<int>(std::floor(y / m_tile_size.height)), 0, m_nb_rows - 1) };
+
+	return tile_y * m_nb_cols + tile_x;
+}
+
+void Tile_index::insert(ecs::Id const& id, Position const& pos, Size const& size)
+{
+	remove(id);
+
+	const size_t index{ ecs::entity_index(id) };
+	if (index >= m_records.size())
+	{
+		m_records.resize(index + 1);
+	}
+
+	const Position center{ get_center(pos, size) };
+	const int tile{ get_tile(center.x, center.y) };
+
+	m_records[index] = Record{ id, tile, m_tiles[tile].size() };
+	m_tiles[tile].push_back(id);
+	m_size++;
+
+	m_max_half_size.width = std::max(m_max_half_size.width, size.width / 2 + 1);
+	m_max_half_size.height = std::max(m_max_half_size.height, size.height / 2 + 1);
+}
+
+bool Tile_index::remove(ecs::Id const& id)
+{
+	if (!contains(id))
+	{
+		return false;
+	}
+
+	Record & record{ m_records[ecs::entity_index(id)] };
+	auto & tile{ m_tiles[record.tile] };
+
+	if (record.slot != tile.size() - 1)
+	{
+		tile[record.slot] = tile.back();
+		m_records[ecs::entity_index(tile[record.slot])].slot = record.slot;
+	}
+	tile.pop_back();
+
+	record = Record{};
+	m_size--;
+
+	return true;
+}
+
+bool Tile_index::contains(ecs::Id const& id) const
+{
+	const size_t index{ ecs::entity_index(id) };
+	return index < m_records.size() && m_records[index].id == id;
+}
+
+void Tile_index::query(Position const& pos, Size const& size, std::vector<ecs::Id> & result) const
+{
+	const int first{ get_tile(pos.x - m_max_half_size.width, pos.y - m_max_half_size.height) };
+	const int last{ get_tile(pos.x + size.width + m_max_half_size.width, pos.y + size.height + m_max_half_size.height) };
+
+	for (int y{ first / m_nb_cols }; y <= last / m_nb_cols; y++)
+	{
+		for (int x{ first % m_nb_cols }; x <= last % m_nb_cols; x++)
+		{
+			auto const& tile{ m_tiles[y * m_nb_cols + x] };
+			result.insert(result.end(), tile.begin(), tile.end());
+		}
+	}
+}
+
+size_t Tile_index::size() const
+{
+	return m_size;
+}
+
+void Tile_index::clear()
+{
+	for (auto & tile : m_tiles) { tile.clear(); }
+	m_records.clear();
+	m_max_half_size = Size{ 0, 0 };
+	m_size = 0;
+}
+
+Tile_index::~Tile_index()
+{
+}
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <set>
+#include <utility>
+#include <algorithm>
+
+#include "sweep_and_prune.h"
+
+// Boxes moved, removed and inserted again over many frames : after each sweep
+// the overlapping pairs and the begin and end events must match a brute force
+// test of every pair
+namespace
+{
+	using Pair = std::pair<ecs::Id, ecs::Id>;
+
+	struct Box
+	{
+		ecs::Id id;
+		Position pos;
+		Size size;
+		bool inside;
+	};
+
+	Pair ordered(ecs::Id const& a, ecs::Id const& b)
+	{
+		return a < b ? Pair{ a, b } : Pair{ b, a };
+	}
+
+	// Same test as ecs::check_collision, edges touching is no overlap
+	bool overlap(Box const& a, Box const& b)
+	{
+		return a.pos.x < b.pos.x + b.size.width && a.pos.x + a.size.width > b.pos.x &&
+			a.pos.y < b.pos.y + b.size.height && a.pos.y + a.size.height > b.pos.y;
+	}
+
+	std::set<Pair> brute_force(std::vector<Box> const& boxes)
+	{
+		std::set<Pair> pairs;
+		for (size_t i{ 0 }; i < boxes.size(); i++)
+		{
+			for (size_t j{ i + 1 }; j < boxes.size(); j++)
+			{
+				if (boxes[i].inside && boxes[j].inside && overlap(boxes[i], boxes[j]))
+				{
+					pairs.insert(ordered(boxes[i].id, boxes[j].id));
+				}
+			}
+		}
+
+		return pairs;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 25 };
+	int failures{ 0 };
+	size_t nb_events{ 0 };
+
+	for (int run{ 0 }; run < 20; run++)
+	{
+		Sweep_and_prune sweep;
+		std::vector<Box> boxes;
+
+		// Whole coordinates and sizes, so edges often touch or share a value
+		auto place{ [&rng](Box & box)
+		{
+			box.pos = Position{ static_cast<float>(rng() % 96), static_cast<float>(rng() % 96) };
+			box.size = Size{ 4 + static_cast<int>(rng() % 12), 4 + static_cast<int>(rng() % 12) };
+		} };
+
+		const int nb_boxes{ 20 + static_cast<int>(rng() % 40) };
+		for (int i{ 0 }; i < nb_boxes; i++)
+		{
+			Box box{ ecs::make_entity(static_cast<std::uint32_t>(i), 1), Position{ 0, 0 }, Size{ 0, 0 }, true };
+			place(box);
+			boxes.push_back(box);
+		}
+
+		std::set<Pair> previous;
+		std::vector<Overlap_event> events;
+
+		for (int frame{ 0 }; frame < 200; frame++)
+		{
+			// Removed boxes come back a later frame, with the next generation of their slot
+			std::vector<size_t> removed;
+			for (size_t i{ 0 }; i < boxes.size(); i++)
+			{
+				Box & box{ boxes[i] };
+				const unsigned int action{ static_cast<unsigned int>(rng() % 100) };
+
+				if (!box.inside)
+				{
+					if (action < 30)
+					{
+						box.id = ecs::make_entity(ecs::entity_index(box.id), ecs::entity_generation(box.id) + 1);
+						box.inside = true;
+						place(box);
+					}
+				}
+				else if (action < 3)
+				{
+					removed.push_back(i);
+				}
+				else if (action < 6)
+				{
+					place(box);
+				}
+				else if (action < 70)
+				{
+					box.pos.x += static_cast<float>(static_cast<int>(rng() % 5) - 2);
+					box.pos.y += static_cast<float>(static_cast<int>(rng() % 5) - 2);
+				}
+			}
+
+			for (auto const& box : boxes)
+			{
+				if (box.inside)
+				{
+					sweep.update(box.id, box.pos, box.size);
+				}
+			}
+			for (auto const& i : removed)
+			{
+				if (!sweep.remove(boxes[i].id))
+				{
+					failures++;
+				}
+				boxes[i].inside = false;
+			}
+
+			events.clear();
+			sweep.sweep(events);
+
+			const std::set<Pair> expected{ brute_force(boxes) };
+
+			std::set<Pair> found;
+			for (auto const& pair : sweep.overlaps())
+			{
+				if (!found.insert(ordered(pair.first, pair.second)).second)
+				{
+					failures++;
+				}
+			}
+			if (found != expected)
+			{
+				failures++;
+			}
+
+			std::set<Pair> begins;
+			std::set<Pair> ends;
+			for (auto const& event : events)
+			{
+				std::set<Pair> & side{ event.begin ? begins : ends };
+				if (!side.insert(ordered(event.first, event.second)).second)
+				{
+					failures++;
+				}
+			}
+			nb_events += events.size();
+
+			std::set<Pair> expected_begins;
+			std::set<Pair> expected_ends;
+			std::set_difference(expected.begin(), expected.end(), previous.begin(), previous.end(), std::inserter(expected_begins, expected_begins.begin()));
+			std::set_difference(previous.begin(), previous.end(), expected.begin(), expected.end(), std::inserter(expected_ends, expected_ends.begin()));
+
+			if (begins != expected_begins || ends != expected_ends)
+			{
+				failures++;
+			}
+
+			previous = expected;
+		}
+	}
+
+	std::cout << "sweep_and_prune : " << failures << " mismatches, " << nb_events << " events checked" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "a_star.h"
+
+// Every path of a find_paths batch must be the one create_center_path gives,
+// batch after batch on the same threads
+namespace
+{
+	bool same_path(Path_batch const& batch, size_t query, std::vector<Position> const& expected)
+	{
+		const size_t first{ batch.offsets[query] };
+		const size_t last{ batch.offsets[query + 1] };
+		if (last - first != expected.size())
+		{
+			return false;
+		}
+
+		for (size_t i{ 0 }; i < expected.size(); i++)
+		{
+			if (batch.positions[first + i].x != expected[i].x || batch.positions[first + i].y != expected[i].y)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 20 };
+	int failures{ 0 };
+
+	for (int map{ 0 }; map < 10; map++)
+	{
+		Map_infos infos;
+		infos.nb_cols = 20 + static_cast<int>(rng() % 30);
+		infos.nb_rows = 20 + static_cast<int>(rng() % 30);
+		infos.tile_size = Size{ 16, 16 };
+		infos.collider_map.resize(infos.nb_cols * infos.nb_rows);
+		for (size_t cell{ 0 }; cell < infos.collider_map.size(); cell++)
+		{
+			infos.collider_map[cell] = rng() % 4 == 0;
+		}
+
+		A_star path_finding{ infos };
+		path_finding.set_batch_threads(4);
+		Path_batch batch;
+
+		auto random_position{ [&rng, &infos]()
+		{
+			return Position{ static_cast<float>(rng() % (infos.nb_cols * 16)), static_cast<float>(rng() % (infos.nb_rows * 16)) };
+		} };
+
+		// Sizes going up and down : threads started, left without a share, then used again
+		for (size_t size : { 200u, 3u, 64u, 0u, 500u, 17u })
+		{
+			std::vector<Path_query> queries(size);
+			for (auto & query : queries)
+			{
+				query = Path_query{ random_position(), random_position() };
+			}
+
+			path_finding.find_paths(queries, batch);
+
+			if (batch.offsets.size() != queries.size() + 1)
+			{
+				failures++;
+				continue;
+			}
+
+			for (size_t query{ 0 }; query < queries.size(); query++)
+			{
+				Path_query const& q{ queries[query] };
+				if (!same_path(batch, query, path_finding.create_center_path(q.start.x, q.start.y, q.goal.x, q.goal.y)))
+				{
+					failures++;
+				}
+			}
+		}
+	}
+
+	if (failures != 0)
+	{
+		std::cout << "batch_paths : " << failures << " paths differing from create_center_path" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
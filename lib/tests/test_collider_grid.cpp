@@ -0,0 +1,182 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "collider_grid.h"
+
+// Every query of the packed grid against the plain wall map, on widths around
+// the 64-bit word boundaries : columns 63 and 64, and a last partial word
+namespace
+{
+	struct Reference
+	{
+		int nb_cols;
+		int nb_rows;
+		std::vector<bool> walls;
+
+		// Outside the grid is a wall
+		bool is_wall(int x, int y) const
+		{
+			return x < 0 || y < 0 || x >= nb_cols || y >= nb_rows || walls[y * nb_cols + x];
+		}
+
+		bool any_wall(int x_1, int y_1, int x_2, int y_2) const
+		{
+			for (int y{ std::min(y_1, y_2) }; y <= std::max(y_1, y_2); y++)
+			{
+				for (int x{ std::min(x_1, x_2) }; x <= std::max(x_1, x_2); x++)
+				{
+					if (is_wall(x, y)) { return true; }
+				}
+			}
+			return false;
+		}
+
+		int first_wall(int y, int x_from, int x_to) const
+		{
+			if (y < 0 || y >= nb_rows) { return -1; }
+
+			x_from = std::max(0, std::min(x_from, nb_cols - 1));
+			x_to = std::max(0, std::min(x_to, nb_cols - 1));
+			const int step{ x_from <= x_to ? 1 : -1 };
+			for (int x{ x_from }; ; x += step)
+			{
+				if (is_wall(x, y)) { return x; }
+				if (x == x_to) { return -1; }
+			}
+		}
+	};
+
+	// Columns next to a word boundary or the grid edge, then any column
+	int pick_column(std::mt19937 & rng, int nb_cols)
+	{
+		const int near[]{ -1, 0, 1, 62, 63, 64, 65, 126, 127, 128, 129, nb_cols - 2, nb_cols - 1, nb_cols };
+		if (rng() % 2 == 0)
+		{
+			return near[rng() % (sizeof(near) / sizeof(near[0]))];
+		}
+		return static_cast<int>(rng() % (nb_cols + 2)) - 1;
+	}
+
+	int check(Collider_grid const& grid, Reference const& reference, std::mt19937 & rng)
+	{
+		int failures{ 0 };
+		const int words{ grid.words_per_row() };
+
+		if (grid.to_wall_map() != reference.walls)
+		{
+			failures++;
+		}
+
+		for (int y{ -1 }; y <= reference.nb_rows; y++)
+		{
+			for (int x{ -2 }; x < reference.nb_cols + 2; x++)
+			{
+				if (grid.is_wall(x, y) != reference.is_wall(x, y))
+				{
+					failures++;
+				}
+			}
+		}
+
+		for (int y{ 0 }; y < reference.nb_rows; y++)
+		{
+			// Bits past the last column read as walls
+			for (int bit{ reference.nb_cols % Collider_grid::word_bits }; reference.nb_cols % Collider_grid::word_bits != 0 && bit < Collider_grid::word_bits; bit++)
+			{
+				if (!((grid.row_word(y, words - 1) >> bit) & 1))
+				{
+					failures++;
+				}
+			}
+
+			for (int word{ -1 }; word <= words; word++)
+			{
+				for (int dy{ -1 }; dy <= 1; dy++)
+				{
+					for (int dx{ -1 }; dx <= 1; dx++)
+					{
+						const std::uint64_t open{ grid.open_neighbors(y, word, dx, dy) };
+
+						for (int bit{ 0 }; bit < Collider_grid::word_bits; bit++)
+						{
+							const int x{ word * Collider_grid::word_bits + bit };
+							const bool inside{ word >= 0 && word < words && x < reference.nb_cols };
+							const bool expected{ inside && !reference.is_wall(x + dx, y + dy) };
+
+							if (((open >> bit) & 1) != static_cast<std::uint64_t>(expected))
+							{
+								failures++;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		if (grid.open_neighbors(-1, 0, 0, 1) != 0 || grid.open_neighbors(reference.nb_rows, 0, 0, -1) != 0)
+		{
+			failures++;
+		}
+
+		for (int query{ 0 }; query < 2000; query++)
+		{
+			const int x_1{ pick_column(rng, reference.nb_cols) };
+			const int x_2{ pick_column(rng, reference.nb_cols) };
+			const int y_1{ static_cast<int>(rng() % (reference.nb_rows + 2)) - 1 };
+			const int y_2{ static_cast<int>(rng() % reference.nb_rows) };
+
+			if (grid.any_wall(x_1, y_1, x_2, y_2) != reference.any_wall(x_1, y_1, x_2, y_2))
+			{
+				failures++;
+			}
+			if (grid.first_wall(y_1, x_1, x_2) != reference.first_wall(y_1, x_1, x_2))
+			{
+				failures++;
+			}
+		}
+
+		return failures;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 18 };
+	int failures{ 0 };
+
+	for (int nb_cols : { 1, 63, 64, 65, 127, 128, 129, 200 })
+	{
+		for (int density : { 0, 2, 8, 50 })
+		{
+			Reference reference{ nb_cols, 5, std::vector<bool>(nb_cols * 5) };
+			for (size_t cell{ 0 }; cell < reference.walls.size(); cell++)
+			{
+				reference.walls[cell] = density != 0 && rng() % density == 0;
+			}
+
+			Collider_grid grid{ reference.nb_cols, reference.nb_rows, reference.walls };
+			failures += check(grid, reference, rng);
+
+			// Walls toggled on the word boundaries and the last column
+			for (int change{ 0 }; change < 40; change++)
+			{
+				const int x{ pick_column(rng, nb_cols) };
+				const int y{ static_cast<int>(rng() % reference.nb_rows) };
+				const bool wall{ rng() % 2 == 0 };
+
+				grid.set_wall(x, y, wall);
+				if (x >= 0 && x < nb_cols)
+				{
+					reference.walls[y * nb_cols + x] = wall;
+				}
+			}
+			failures += check(grid, reference, rng);
+		}
+	}
+
+	std::cout << "collider_grid : " << failures << " mismatches" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
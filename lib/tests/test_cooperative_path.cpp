@@ -0,0 +1,119 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "a_star.h"
+
+// Agents planned one after the other must never hold the same tile at the same
+// step, nor swap tiles, counting the goal tile an agent stays on once there
+namespace
+{
+	const int window{ 8 };
+	const int tile{ 16 };
+
+	int cell_of(Position const& position, int nb_cols)
+	{
+		return static_cast<int>(std::floor(position.y / tile)) * nb_cols + static_cast<int>(std::floor(position.x / tile));
+	}
+
+	// Tile of the agent at every step of the window, -1 once it stops being planned
+	std::vector<int> timeline(std::vector<Position> const& path, int goal_cell, int nb_cols)
+	{
+		std::vector<int> cells(window + 1, -1);
+		for (size_t step{ 0 }; step < path.size(); step++)
+		{
+			cells[step] = cell_of(path[path.size() - 1 - step], nb_cols);
+		}
+
+		const int last{ cells[path.size() - 1] };
+		for (size_t step{ path.size() }; last == goal_cell && step <= window; step++)
+		{
+			cells[step] = last;
+		}
+
+		return cells;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 21 };
+	int failures{ 0 };
+
+	for (int map{ 0 }; map < 100; map++)
+	{
+		Map_infos infos;
+		infos.nb_cols = 8 + static_cast<int>(rng() % 8);
+		infos.nb_rows = 8 + static_cast<int>(rng() % 8);
+		infos.tile_size = Size{ tile, tile };
+		infos.collider_map.resize(infos.nb_cols * infos.nb_rows);
+		for (size_t cell{ 0 }; cell < infos.collider_map.size(); cell++)
+		{
+			infos.collider_map[cell] = rng() % 5 == 0;
+		}
+
+		A_star path_finding{ infos };
+		Reservation_table reservations;
+
+		auto center{ [&infos](int cell)
+		{
+			return Position{ static_cast<float>((cell % infos.nb_cols) * tile + tile / 2), static_cast<float>((cell / infos.nb_cols) * tile + tile / 2) };
+		} };
+
+		// Distinct open starts, goals close enough to be reached within the window
+		std::vector<int> starts;
+		while (starts.size() < 6)
+		{
+			const int cell{ static_cast<int>(rng() % infos.collider_map.size()) };
+			if (!infos.collider_map[cell] && std::find(starts.begin(), starts.end(), cell) == starts.end())
+			{
+				starts.push_back(cell);
+			}
+		}
+
+		std::vector<std::vector<int>> timelines;
+		for (size_t agent{ 0 }; agent < starts.size(); agent++)
+		{
+			const int goal_cell{ static_cast<int>(rng() % infos.collider_map.size()) };
+			const Position start{ center(starts[agent]) };
+			const std::vector<Position> path{ path_finding.create_cooperative_path(reservations, ecs::make_entity(static_cast<std::uint32_t>(agent), 1), start, start, center(goal_cell), window) };
+
+			if (!path.empty())
+			{
+				timelines.push_back(timeline(path, goal_cell, infos.nb_cols));
+			}
+		}
+
+		for (size_t a{ 0 }; a < timelines.size(); a++)
+		{
+			for (size_t b{ a + 1 }; b < timelines.size(); b++)
+			{
+				for (int step{ 0 }; step <= window; step++)
+				{
+					const int cell_a{ timelines[a][step] };
+					const int cell_b{ timelines[b][step] };
+					if (cell_a == -1 || cell_b == -1)
+					{
+						continue;
+					}
+
+					const bool swapped{ step > 0 && cell_a == timelines[b][step - 1] && cell_b == timelines[a][step - 1] && cell_a != cell_b };
+					if (cell_a == cell_b || swapped)
+					{
+						failures++;
+					}
+				}
+			}
+		}
+	}
+
+	if (failures != 0)
+	{
+		std::cout << "cooperative_path : " << failures << " tiles held by two agents at once" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
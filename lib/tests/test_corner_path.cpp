@@ -0,0 +1,114 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "a_star.h"
+#include "path_buffer.h"
+#include "corner_path.h"
+
+// The corner an ai follows : its top left corner only when that path is
+// strictly longer, the bottom right one otherwise, even when a corner sits on
+// a wall tile the box overlaps
+namespace
+{
+	const int tile{ 16 };
+
+	bool same(Position const& a, Position const& b)
+	{
+		return a.x == b.x && a.y == b.y;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 23 };
+	int failures{ 0 };
+
+	// Corner positions and ties
+	{
+		const Position pos{ 10, 20 };
+		const Size size{ 27, 29 };
+		Position seen[2];
+		auto lengths{ [&seen](size_t length_1, size_t length_2)
+		{
+			return [&seen, length_1, length_2](int i, Position const& pos)
+			{
+				seen[i] = pos;
+				return i == 0 ? length_1 : length_2;
+			};
+		} };
+
+		if (longer_corner(pos, size, lengths(5, 3)) != 0 || !same(seen[0], pos) || !same(seen[1], Position{ 37, 49 }))
+		{
+			failures++;
+		}
+		if (longer_corner(pos, size, lengths(3, 5)) != 1 || longer_corner(pos, size, lengths(4, 4)) != 1 || longer_corner(pos, size, lengths(0, 0)) != 1)
+		{
+			failures++;
+		}
+	}
+
+	// next_step reads the step after the ai tile, none on a path that short
+	{
+		Position next{ -1, -1 };
+		if (next_step({}, next) || next_step({ Position{ 1, 1 } }, next) || !same(next, Position{ -1, -1 }))
+		{
+			failures++;
+		}
+		if (!next_step({ Position{ 1, 1 }, Position{ 2, 2 }, Position{ 3, 3 } }, next) || !same(next, Position{ 2, 2 }))
+		{
+			failures++;
+		}
+	}
+
+	// The buffered step against the step of the corner choose_path would pick
+	size_t nb_steps{ 0 };
+	for (int map{ 0 }; map < 40; map++)
+	{
+		Map_infos infos;
+		infos.nb_cols = 8 + static_cast<int>(rng() % 24);
+		infos.nb_rows = 8 + static_cast<int>(rng() % 24);
+		infos.tile_size = Size{ tile, tile };
+		infos.collider_map.resize(infos.nb_cols * infos.nb_rows);
+		for (size_t cell{ 0 }; cell < infos.collider_map.size(); cell++)
+		{
+			infos.collider_map[cell] = rng() % 4 == 0;
+		}
+
+		A_star path_finding{ infos };
+		const size_t capacity{ path_finding.max_path_length() };
+		Path_buffer corners[2]{ Path_buffer{ capacity }, Path_buffer{ capacity } };
+
+		for (int query{ 0 }; query < 100; query++)
+		{
+			// Boxes up to two tiles wide, straddling tiles and walls
+			const Size size{ 1 + static_cast<int>(rng() % (2 * tile)), 1 + static_cast<int>(rng() % (2 * tile)) };
+			const Position pos{ static_cast<float>(rng() % ((infos.nb_cols - 2) * tile)), static_cast<float>(rng() % ((infos.nb_rows - 2) * tile)) };
+			const Position goal{ static_cast<float>(rng() % (infos.nb_cols * tile)), static_cast<float>(rng() % (infos.nb_rows * tile)) };
+
+			std::vector<Position> paths[2];
+			const int corner{ longer_corner(pos, size, [&](int i, Position const& corner_pos)
+			{
+				paths[i] = path_finding.create_center_path(corner_pos.x, corner_pos.y, goal.x, goal.y);
+				return paths[i].size();
+			}) };
+			const int expected_corner{ paths[0].size() > paths[1].size() ? 0 : 1 };
+
+			Position expected;
+			const bool has_expected{ next_step(paths[expected_corner], expected) };
+
+			Position next;
+			const bool has_next{ choose_buffered_step(path_finding, corners, pos, size, goal, next) };
+
+			if (corner != expected_corner || has_next != has_expected || (has_next && !same(next, expected)))
+			{
+				failures++;
+			}
+			nb_steps++;
+		}
+	}
+
+	std::cout << "corner_path : " << failures << " mismatches over " << nb_steps << " steps" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <algorithm>
+
+#include "hierarchical_path.h"
+
+// After set_wall the abstract graph must be the one a full rebuild gives
+namespace
+{
+	using Edges = std::vector<Hierarchical_path::Abstract_edge>;
+
+	Edges sorted_edges(Hierarchical_path const& path)
+	{
+		Edges edges;
+		path.abstract_edges(edges);
+
+		std::sort(edges.begin(), edges.end(), [](auto const& a, auto const& b)
+		{
+			return std::tie(a.from_cell, a.to_cell, a.cost) < std::tie(b.from_cell, b.to_cell, b.cost);
+		});
+
+		return edges;
+	}
+
+	bool same_edges(Edges const& a, Edges const& b)
+	{
+		return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto const& x, auto const& y)
+		{
+			return x.from_cell == y.from_cell && x.to_cell == y.to_cell && x.cost == y.cost;
+		});
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 12 };
+	int failures{ 0 };
+
+	for (int map{ 0 }; map < 60; map++)
+	{
+		const int nb_cols{ 20 + static_cast<int>(rng() % 30) };
+		const int nb_rows{ 20 + static_cast<int>(rng() % 30) };
+		const int cluster_size{ 4 + static_cast<int>(rng() % 6) };
+
+		std::vector<bool> wall_map(nb_cols * nb_rows);
+		for (size_t cell{ 0 }; cell < wall_map.size(); cell++)
+		{
+			wall_map[cell] = rng() % 4 == 0;
+		}
+
+		Hierarchical_path updated;
+		updated.rebuild(nb_cols, nb_rows, wall_map, cluster_size);
+
+		for (int toggle{ 0 }; toggle < 10; toggle++)
+		{
+			const Index index{ static_cast<int>(rng() % nb_cols), static_cast<int>(rng() % nb_rows) };
+			const int cell{ index.y * nb_cols + index.x };
+
+			wall_map[cell] = !wall_map[cell];
+			updated.set_wall(index, wall_map[cell]);
+
+			Hierarchical_path rebuilt;
+			rebuilt.rebuild(nb_cols, nb_rows, wall_map, cluster_size);
+
+			if (!same_edges(sorted_edges(updated), sorted_edges(rebuilt)) || updated.nb_abstract_nodes() != rebuilt.nb_abstract_nodes())
+			{
+				failures++;
+				continue;
+			}
+
+			for (int query{ 0 }; query < 5; query++)
+			{
+				const Index start{ static_cast<int>(rng() % nb_cols), static_cast<int>(rng() % nb_rows) };
+				const Index goal{ static_cast<int>(rng() % nb_cols), static_cast<int>(rng() % nb_rows) };
+
+				std::vector<int> cells_updated;
+				std::vector<int> cells_rebuilt;
+				if (updated.find_path(start, goal, cells_updated) != rebuilt.find_path(start, goal, cells_rebuilt))
+				{
+					failures++;
+				}
+			}
+		}
+	}
+
+	if (failures != 0)
+	{
+		std::cout << "hierarchical_path : " << failures << " mismatches against a full rebuild" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+#include "a_star.h"
+#include "jump_point_search.h"
+
+// Jump Point Search must find paths as short as plain A*, before and after
+// walls are added or removed and the jump distances rebuilt
+namespace
+{
+	const int tile{ 16 };
+
+	// Goal back to start, every step to an open neighbor ; like plain A*, a start
+	// on a wall can still be left
+	bool valid_path(std::vector<int> const& cells, std::vector<bool> const& wall_map, int nb_cols, int start, int goal)
+	{
+		if (cells.empty() || cells.front() != goal || cells.back() != start)
+		{
+			return false;
+		}
+
+		for (size_t i{ 0 }; i < cells.size(); i++)
+		{
+			if (wall_map[cells[i]] && i + 1 < cells.size())
+			{
+				return false;
+			}
+			if (i > 0)
+			{
+				const int dx{ std::abs(cells[i] % nb_cols - cells[i - 1] % nb_cols) };
+				const int dy{ std::abs(cells[i] / nb_cols - cells[i - 1] / nb_cols) };
+				if (dx + dy != 1)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 11 };
+	int failures{ 0 };
+	size_t nb_paths{ 0 };
+
+	for (int map{ 0 }; map < 40; map++)
+	{
+		Map_infos infos;
+		infos.nb_cols = 8 + static_cast<int>(rng() % 40);
+		infos.nb_rows = 8 + static_cast<int>(rng() % 40);
+		infos.tile_size = Size{ tile, tile };
+		infos.collider_map.resize(infos.nb_cols * infos.nb_rows);
+		for (size_t cell{ 0 }; cell < infos.collider_map.size(); cell++)
+		{
+			infos.collider_map[cell] = rng() % 4 == 0;
+		}
+
+		A_star path_finding{ infos };
+		Jump_point_search jump_search;
+		std::vector<bool> wall_map{ infos.collider_map };
+		jump_search.rebuild(infos.nb_cols, infos.nb_rows, wall_map);
+
+		const int nb_cells{ infos.nb_cols * infos.nb_rows };
+		auto center{ [&infos](int cell)
+		{
+			return Position{ static_cast<float>((cell % infos.nb_cols) * tile + tile / 2), static_cast<float>((cell / infos.nb_cols) * tile + tile / 2) };
+		} };
+
+		for (int edit{ 0 }; edit < 10; edit++)
+		{
+			for (int query{ 0 }; query < 30; query++)
+			{
+				const int start{ static_cast<int>(rng() % nb_cells) };
+				const int goal{ static_cast<int>(rng() % nb_cells) };
+				const Position from{ center(start) };
+				const Position to{ center(goal) };
+
+				const size_t expected{ path_finding.create_center_path(from.x, from.y, to.x, to.y).size() };
+
+				// Through A_star, rebuilt by set_collider
+				if (path_finding.create_jump_path(from.x, from.y, to.x, to.y).size() != expected)
+				{
+					failures++;
+				}
+
+				// Directly, rebuilt here
+				std::vector<int> cells;
+				const bool found{ jump_search.find_path(Index{ start % infos.nb_cols, start / infos.nb_cols }, Index{ goal % infos.nb_cols, goal / infos.nb_cols }, cells) };
+				if (found != (expected != 0) || (found && (cells.size() != expected || !valid_path(cells, wall_map, infos.nb_cols, start, goal))))
+				{
+					failures++;
+				}
+
+				nb_paths++;
+			}
+
+			// A few walls added or removed, then the jump distances rebuilt
+			for (int change{ 0 }; change < 4; change++)
+			{
+				const int cell{ static_cast<int>(rng() % nb_cells) };
+				wall_map[cell] = !wall_map[cell];
+				path_finding.set_collider(Index{ cell % infos.nb_cols, cell / infos.nb_cols }, wall_map[cell]);
+			}
+			jump_search.rebuild(infos.nb_cols, infos.nb_rows, wall_map);
+		}
+	}
+
+	std::cout << "jump_point_search : " << failures << " mismatches over " << nb_paths << " paths" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+#include "a_star.h"
+#include "corner_path.h"
+
+// Once the buffers hold max_path_length(), write_center_path and
+// choose_buffered_step must not allocate, whichever branch answers
+namespace
+{
+	size_t allocations{ 0 };
+}
+
+void * operator new(std::size_t size)
+{
+	allocations++;
+	if (void * memory{ std::malloc(size == 0 ? 1 : size) })
+	{
+		return memory;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void * memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void * memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+int main()
+{
+	std::mt19937 rng{ 22 };
+	int failures{ 0 };
+
+	Map_infos infos;
+	infos.nb_cols = 40;
+	infos.nb_rows = 30;
+	infos.tile_size = Size{ 16, 16 };
+	infos.collider_map.resize(infos.nb_cols * infos.nb_rows);
+	for (size_t cell{ 0 }; cell < infos.collider_map.size(); cell++)
+	{
+		infos.collider_map[cell] = rng() % 4 == 0;
+	}
+	// Flow field target
+	infos.collider_map[0] = false;
+
+	A_star path_finding{ infos };
+	const Position flow_target{ 8, 8 };
+	path_finding.set_flow_field_enabled(true);
+	path_finding.update_flow_field(flow_target.x, flow_target.y);
+
+	Path_buffer buffer{ path_finding.max_path_length() };
+	Path_buffer corners[2]{ Path_buffer{ path_finding.max_path_length() }, Path_buffer{ path_finding.max_path_length() } };
+	const Size hitbox{ 12, 12 };
+
+	auto random_position{ [&rng, &infos]()
+	{
+		return Position{ static_cast<float>(rng() % (infos.nb_cols * 16 - 12)), static_cast<float>(rng() % (infos.nb_rows * 16 - 12)) };
+	} };
+
+	// Search, flow field and distance table branches, each warmed up by a first round
+	for (int branch{ 0 }; branch < 3; branch++)
+	{
+		if (branch == 2)
+		{
+			path_finding.set_flow_field_enabled(false);
+			path_finding.enable_distance_table("");
+		}
+
+		for (int round{ 0 }; round < 2; round++)
+		{
+			const size_t before{ allocations };
+
+			for (int query{ 0 }; query < 200; query++)
+			{
+				const Position start{ random_position() };
+				const Position goal{ branch == 1 ? flow_target : random_position() };
+				Position next;
+
+				path_finding.write_center_path(buffer, start.x, start.y, goal.x, goal.y);
+				choose_buffered_step(path_finding, corners, start, hitbox, goal, next);
+			}
+
+			if (round == 1 && allocations != before)
+			{
+				std::cout << "path_allocations : " << allocations - before << " allocations on branch " << branch << std::endl;
+				failures++;
+			}
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}